@@ -0,0 +1,173 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Benchmark of heap allocations made while constructing a command tree:
+ * initializer_list construction, which copies every option and sub-command,
+ * versus construction that moves options and builds sub-commands in place,
+ * versus lazy sub-commands which options are not built until a sub-command is selected.
+*/
+
+#include <clime/parser.hpp>
+
+#include "support/allocations.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+/// Each tree has kCommandsPerTree commands, so the total is 400 commands.
+constexpr int kNbTrees = 100;
+constexpr int kCommandsPerTree = 4;
+
+
+struct Settings {
+	bool	verbose{false};
+	bool	dryRun{false};
+	int32	retries{0};
+	uint32	timeout{0};
+	uint16	port{0};
+	StringView	host;
+	StringView	user;
+	float64	ratio{0};
+};
+
+
+Result<void, Error> noop() {
+	return Ok();
+}
+
+
+void buildFromLists(Parser& parser, Settings& s) {
+	parser.commands({
+		{"start", {"Start service", noop, {
+			{{"v", "verbose"}, "Verbose output", &s.verbose},
+			{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+			{{"r", "retries"}, "Number of retries", &s.retries},
+			{{"t", "timeout"}, "Timeout", &s.timeout},
+			{{"p", "port"}, "Port", &s.port},
+			{{"H", "host"}, "Host", &s.host},
+			{{"u", "user"}, "User", &s.user},
+			{{"ratio"}, "Ratio", &s.ratio}
+		}}},
+		{"stop", {"Stop service", noop, {
+			{{"v", "verbose"}, "Verbose output", &s.verbose},
+			{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+			{{"r", "retries"}, "Number of retries", &s.retries},
+			{{"t", "timeout"}, "Timeout", &s.timeout},
+			{{"p", "port"}, "Port", &s.port},
+			{{"H", "host"}, "Host", &s.host},
+			{{"u", "user"}, "User", &s.user},
+			{{"ratio"}, "Ratio", &s.ratio}
+		}}},
+		{"status", {"Query status", noop, {
+			{{"v", "verbose"}, "Verbose output", &s.verbose},
+			{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+			{{"r", "retries"}, "Number of retries", &s.retries},
+			{{"t", "timeout"}, "Timeout", &s.timeout},
+			{{"p", "port"}, "Port", &s.port},
+			{{"H", "host"}, "Host", &s.host},
+			{{"u", "user"}, "User", &s.user},
+			{{"ratio"}, "Ratio", &s.ratio}
+		}}},
+		{"reload", {"Reload configuration", noop, {
+			{{"v", "verbose"}, "Verbose output", &s.verbose},
+			{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+			{{"r", "retries"}, "Number of retries", &s.retries},
+			{{"t", "timeout"}, "Timeout", &s.timeout},
+			{{"p", "port"}, "Port", &s.port},
+			{{"H", "host"}, "Host", &s.host},
+			{{"u", "user"}, "User", &s.user},
+			{{"ratio"}, "Ratio", &s.ratio}
+		}}}
+	});
+}
+
+
+void buildByMoving(Parser& parser, Settings& s) {
+	using Option = Parser::Option;
+
+	for (auto name : {"start", "stop", "status", "reload"}) {
+		parser.addCommand(name, "Command", noop)
+			.options(Option{{"v", "verbose"}, "Verbose output", &s.verbose},
+					 Option{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+					 Option{{"r", "retries"}, "Number of retries", &s.retries},
+					 Option{{"t", "timeout"}, "Timeout", &s.timeout},
+					 Option{{"p", "port"}, "Port", &s.port},
+					 Option{{"H", "host"}, "Host", &s.host},
+					 Option{{"u", "user"}, "User", &s.user},
+					 Option{{"ratio"}, "Ratio", &s.ratio});
+	}
+}
+
+
+void buildLazily(Parser& parser, Settings& s) {
+	using Option = Parser::Option;
+
+	for (auto name : {"start", "stop", "status", "reload"}) {
+		parser.addCommand(name, Parser::Command::lazy("Command", [&s]() {
+			auto command = Parser::Command{"Command", noop};
+			command.options(Option{{"v", "verbose"}, "Verbose output", &s.verbose},
+							Option{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+							Option{{"r", "retries"}, "Number of retries", &s.retries},
+							Option{{"t", "timeout"}, "Timeout", &s.timeout},
+							Option{{"p", "port"}, "Port", &s.port},
+							Option{{"H", "host"}, "Host", &s.host},
+							Option{{"u", "user"}, "User", &s.user},
+							Option{{"ratio"}, "Ratio", &s.ratio});
+			return command;
+		}));
+	}
+}
+
+
+template<typename F>
+void run(char const* name, F&& build) {
+	Settings settings;
+	auto const allocationsBefore = clime::test::allocationsSoFar().count;
+	auto const start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < kNbTrees; ++i) {
+		auto parser = Parser{"Benchmark"};
+		build(parser, settings);
+	}
+
+	auto const elapsed = std::chrono::steady_clock::now() - start;
+	auto const allocations = clime::test::allocationsSoFar().count - allocationsBefore;
+
+	std::cout << name << ": "
+			  << allocations / (kNbTrees * kCommandsPerTree) << " allocations per command, "
+			  << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() << "us for "
+			  << kNbTrees * kCommandsPerTree << " commands\n";
+}
+
+}  // namespace
+
+
+int main() {
+	run("initializer_list", buildFromLists);
+	run("move", buildByMoving);
+	run("lazy", buildLazily);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,344 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Macro benchmark replaying a corpus of command lines through Parser::parse.
+ * Reports p50 / p99 time per parse and heap allocations per parse, and compares them against a stored baseline:
+ * the benchmark fails if a result has regressed past the given tolerance, has no baseline entry,
+ * or if the baseline can not be loaded.
+ *
+ * Synthetic corpora are shaped like large tools: one with 400 sub-commands, one with 1,500 top-level options.
+ * A corpus captured with clime::extras::captureArgv() can be replayed through either of the synthetic tools.
+ *
+ * Example:
+ *   bench_replay --save-baseline=replay.baseline
+ *   bench_replay --baseline=replay.baseline --time-tolerance=15
+*/
+
+#include <clime/parser.hpp>
+#include <clime/extras/argvCorpus.hpp>
+
+#include "support/allocations.hpp"
+
+#include <solace/output_utils.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace Solace;
+using namespace clime;
+using clime::extras::ArgvCorpus;
+
+
+namespace {
+
+constexpr int kNbCommands = 400;
+constexpr int kNbOptions = 1500;
+constexpr int kNbSyntheticLines = 10000;
+
+/// Names are fixed width so that they fill char arrays, which can then be used as StringLiteral.
+char commandNames[kNbCommands][5];
+char optionNames[kNbOptions][6];
+
+
+struct Settings {
+	bool	verbose{false};
+	bool	dryRun{false};
+	int32	retries{0};
+	uint32	timeout{0};
+	uint16	port{0};
+	StringView	host;
+	StringView	user;
+	float64	ratio{0};
+
+	std::vector<int32> values = std::vector<int32>(kNbOptions);
+};
+
+
+Result<void, Error> noop() {
+	return Ok();
+}
+
+
+/// Tool with kNbCommands sub-commands, each with the same eight options.
+void buildCommandsTool(Parser& parser, Settings& s) {
+	using Option = Parser::Option;
+
+	for (int i = 0; i < kNbCommands; ++i) {
+		parser.addCommand(commandNames[i], "Command", noop)
+			.options(Option{{"v", "verbose"}, "Verbose output", &s.verbose},
+					 Option{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+					 Option{{"r", "retries"}, "Number of retries", &s.retries},
+					 Option{{"t", "timeout"}, "Timeout", &s.timeout},
+					 Option{{"p", "port"}, "Port", &s.port},
+					 Option{{"H", "host"}, "Host", &s.host},
+					 Option{{"u", "user"}, "User", &s.user},
+					 Option{{"ratio"}, "Ratio", &s.ratio});
+	}
+}
+
+
+/// Tool with kNbOptions top-level integer options.
+void buildOptionsTool(Parser& parser, Settings& s) {
+	std::vector<Parser::Option> options;
+	options.reserve(kNbOptions);
+	for (int i = 0; i < kNbOptions; ++i) {
+		options.push_back(Parser::Option{{StringLiteral{optionNames[i]}}, "Option", &s.values[i]});
+	}
+
+	parser.options(mv(options));
+}
+
+
+ArgvCorpus synthesizeCommandsCorpus() {
+	static char const* const kOptions[][2] = {
+		{"-v", nullptr}, {"--dry-run", nullptr}, {"-r", "3"}, {"--timeout=30"}, {"--port", "8080"},
+		{"-H", "example.com"}, {"--user=admin"}, {"--ratio=0.75"}
+	};
+
+	std::mt19937 random{20261018};
+	std::vector<const char*> args;
+	ArgvCorpus corpus;
+	for (int line = 0; line < kNbSyntheticLines; ++line) {
+		args.assign({"tool", commandNames[random() % kNbCommands]});
+		for (auto nbOptions = random() % 6; nbOptions > 0; --nbOptions) {
+			for (auto token : kOptions[random() % std::size(kOptions)]) {
+				if (token) {
+					args.push_back(token);
+				}
+			}
+		}
+
+		corpus.append(arrayView(args.data(), args.size()));
+	}
+
+	return corpus;
+}
+
+
+ArgvCorpus synthesizeOptionsCorpus() {
+	std::mt19937 random{20261018};
+	std::vector<std::string> tokens;
+	std::vector<const char*> args;
+	ArgvCorpus corpus;
+	for (int line = 0; line < kNbSyntheticLines; ++line) {
+		tokens.clear();
+		for (auto nbOptions = 1 + random() % 20; nbOptions > 0; --nbOptions) {
+			tokens.push_back(std::string{"--"} + optionNames[random() % kNbOptions] + "=" +
+							 std::to_string(random() % 100000));
+		}
+
+		args.assign({"tool"});
+		for (auto const& token : tokens) {
+			args.push_back(token.c_str());
+		}
+
+		corpus.append(arrayView(args.data(), args.size()));
+	}
+
+	return corpus;
+}
+
+
+struct Measurement {
+	std::string	name;
+	float64		p50{0};
+	float64		p99{0};
+	float64		allocations{0};
+};
+
+
+template<typename F>
+Measurement run(std::string name, F&& build, ArgvCorpus const& corpus, uint32 iterations) {
+	Settings settings;
+	auto parser = Parser{"Replay benchmark"};
+	build(parser, settings);
+
+	std::vector<int64> samples;
+	samples.reserve(static_cast<size_t>(corpus.size()) * iterations);
+
+	// Warm up caches and lazily built state before measuring
+	for (ArgvCorpus::size_type i = 0; i < corpus.size(); ++i) {
+		parser.parse(corpus[i]);
+	}
+
+	uint64 nbFailed = 0;
+	auto const allocationsBefore = clime::test::allocationsSoFar().count;
+	for (uint32 iteration = 0; iteration < iterations; ++iteration) {
+		for (ArgvCorpus::size_type i = 0; i < corpus.size(); ++i) {
+			auto const start = std::chrono::steady_clock::now();
+			auto result = parser.parse(corpus[i]);
+			auto const elapsed = std::chrono::steady_clock::now() - start;
+
+			samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			nbFailed += result ? 0 : 1;
+		}
+	}
+	auto const allocations = clime::test::allocationsSoFar().count - allocationsBefore;
+
+	auto percentile = [&samples](size_t p) {
+		auto const nth = samples.begin() + (samples.size() - 1) * p / 100;
+		std::nth_element(samples.begin(), nth, samples.end());
+		return static_cast<float64>(*nth);
+	};
+
+	Measurement m;
+	m.name = mv(name);
+	m.p50 = percentile(50);
+	m.p99 = percentile(99);
+	m.allocations = static_cast<float64>(allocations) / static_cast<float64>(samples.size());
+
+	std::cout << m.name << ": " << samples.size() << " parses (" << nbFailed << " failed), "
+			  << "p50 " << m.p50 << "ns, p99 " << m.p99 << "ns, "
+			  << m.allocations << " allocations per parse\n";
+
+	return m;
+}
+
+
+/// Load a baseline saved by saveBaseline(). @return False if the file can not be read, is malformed or is empty.
+bool loadBaseline(StringView path, std::vector<Measurement>& baseline) {
+	std::ifstream input{std::string{path.data(), path.size()}};
+	Measurement m;
+	while (input >> m.name >> m.p50 >> m.p99 >> m.allocations) {
+		baseline.push_back(m);
+	}
+
+	return input.eof() && !baseline.empty();
+}
+
+
+bool saveBaseline(StringView path, std::vector<Measurement> const& results) {
+	std::ofstream output{std::string{path.data(), path.size()}};
+	for (auto const& m : results) {
+		output << m.name << ' ' << m.p50 << ' ' << m.p99 << ' ' << m.allocations << '\n';
+	}
+
+	return static_cast<bool>(output);
+}
+
+
+/// Check a value against its baseline. @return True if the value has regressed past the tolerance.
+bool isRegression(char const* what, Measurement const& m, float64 value, float64 base, float64 tolerance) {
+	auto const limit = base * (1 + tolerance / 100);
+	if (value <= limit) {
+		return false;
+	}
+
+	std::cerr << "REGRESSION " << m.name << ' ' << what << ": " << value << " > " << base
+			  << " (+" << tolerance << "%)\n";
+	return true;
+}
+
+}  // namespace
+
+
+int main(int argc, const char** argv) {
+	StringView corpusPath;
+	StringView toolName{"commands"};
+	StringView baselinePath;
+	StringView saveBaselinePath;
+	uint32 iterations = 5;
+	float64 timeTolerance = 10;
+	float64 allocationTolerance = 0;
+
+	auto const res = Parser{"Corpus replay benchmark", {
+			Parser::printHelp(),
+			{{"corpus"}, "Corpus file to replay instead of the synthetic ones", &corpusPath},
+			{{"tool"}, "Synthetic tool to replay the corpus file through: commands or options", &toolName},
+			{{"iterations"}, "Number of passes over each corpus", &iterations},
+			{{"baseline"}, "Baseline to compare results against", &baselinePath},
+			{{"save-baseline"}, "File to save results into, to be used as a baseline", &saveBaselinePath},
+			{{"time-tolerance"}, "Regression of p50 / p99 time tolerated, in percents", &timeTolerance},
+			{{"alloc-tolerance"}, "Regression of allocations per parse tolerated, in percents", &allocationTolerance}
+		}}
+		.parse(argc, argv);
+
+	if (!res) {
+		auto& error = res.getError();
+		if (error) {
+			std::cerr << error << '\n';
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	for (int i = 0; i < kNbCommands; ++i) {
+		std::snprintf(commandNames[i], sizeof(commandNames[i]), "c%03d", i);
+	}
+	for (int i = 0; i < kNbOptions; ++i) {
+		std::snprintf(optionNames[i], sizeof(optionNames[i]), "o%04d", i);
+	}
+
+	std::vector<Measurement> results;
+	if (corpusPath.empty()) {
+		results.push_back(run("commands", buildCommandsTool, synthesizeCommandsCorpus(), iterations));
+		results.push_back(run("options", buildOptionsTool, synthesizeOptionsCorpus(), iterations));
+	} else {
+		auto maybeCorpus = ArgvCorpus::load(corpusPath);
+		if (!maybeCorpus) {
+			std::cerr << maybeCorpus.getError() << '\n';
+			return EXIT_FAILURE;
+		}
+
+		auto const build = (toolName == StringView{"options"}) ? buildOptionsTool : buildCommandsTool;
+		results.push_back(run(std::string{"corpus-"} + std::string{toolName.data(), toolName.size()},
+							  build, maybeCorpus.unwrap(), iterations));
+	}
+
+	if (!saveBaselinePath.empty() && !saveBaseline(saveBaselinePath, results)) {
+		std::cerr << "Failed to save baseline to " << saveBaselinePath << '\n';
+		return EXIT_FAILURE;
+	}
+
+	if (baselinePath.empty()) {
+		return EXIT_SUCCESS;
+	}
+
+	std::vector<Measurement> baseline;
+	if (!loadBaseline(baselinePath, baseline)) {
+		std::cerr << "Failed to load baseline from " << baselinePath << '\n';
+		return EXIT_FAILURE;
+	}
+
+	bool regressed = false;
+	for (auto const& m : results) {
+		auto const base = std::find_if(baseline.begin(), baseline.end(), [&m](auto const& b) {
+			return b.name == m.name;
+		});
+		if (base == baseline.end()) {
+			std::cerr << "NO BASELINE " << m.name << '\n';
+			regressed = true;
+			continue;
+		}
+
+		// Note: Non-short-circuit operator to report every regression
+		regressed |= isRegression("p50 ns", m, m.p50, base->p50, timeTolerance);
+		regressed |= isRegression("p99 ns", m, m.p99, base->p99, timeTolerance);
+		regressed |= isRegression("allocations", m, m.allocations, base->allocations, allocationTolerance);
+	}
+
+	return regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
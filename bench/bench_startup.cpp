@@ -0,0 +1,308 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Benchmark of process startup latency of clime-based executables:
+ * wall time from posix_spawn() to the first byte written by the action selected by a command line.
+ *
+ * Each probe executable (bench/startup/probe_*.cpp) marks its startup phases and writes their timestamps
+ * as the first bytes of its action's output, which breaks the latency down into:
+ * exec and loading, static initialization, parser construction, parsing and dispatch to the action.
+ * Page faults are taken from wait4() rusage of each child and instructions retired,
+ * when perf events are available, from a counter inherited by the children.
+ *
+ * Example:
+ *   bench_startup --runs=5000
+*/
+
+#include "startup/probe.hpp"
+
+#include <clime/parser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+extern char** environ;
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+struct Probe {
+	char const*					name;
+	std::vector<char const*>	args;
+};
+
+
+struct Sample {
+	uint64	firstByte;
+	uint64	phases[probe::kNbPhases];	//!< Duration of each phase: from spawn to kLoaded, then from phase to phase.
+	uint64	minorFaults;
+	uint64	majorFaults;
+	uint64	instructions;
+};
+
+
+constexpr char const* kPhaseNames[probe::kNbPhases] = {
+	"exec+load", "static init", "construct", "parse", "dispatch"
+};
+
+
+uint64 now() noexcept {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64>(ts.tv_sec) * 1000000000ULL + static_cast<uint64>(ts.tv_nsec);
+}
+
+
+/// Open a counter of user space instructions of this process and of children it spawns afterwards.
+int openInstructionCounter() noexcept {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+
+uint64 readCounter(int fd) noexcept {
+	uint64 value = 0;
+	if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+		return 0;
+	}
+
+	return value;
+}
+
+
+/// Read exactly size bytes unless the pipe is closed. @return Number of bytes read.
+size_t readFully(int fd, void* buffer, size_t size) noexcept {
+	size_t done = 0;
+	while (done < size) {
+		auto const n = read(fd, static_cast<char*>(buffer) + done, size - done);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			break;
+		}
+
+		done += static_cast<size_t>(n);
+	}
+
+	return done;
+}
+
+
+/// Spawn a probe once. @return False if the probe has failed to report.
+bool runOnce(std::string const& path, std::vector<char*>& argv, int counter, Sample& sample) {
+	int fds[2];
+	if (pipe2(fds, O_CLOEXEC) < 0) {
+		return false;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+	auto const instructionsBefore = readCounter(counter);
+	auto const spawnTime = now();
+
+	pid_t pid;
+	auto const spawnError = posix_spawn(&pid, path.c_str(), &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(fds[1]);
+	if (spawnError != 0) {
+		close(fds[0]);
+		std::cerr << path << ": " << std::strerror(spawnError) << '\n';
+		return false;
+	}
+
+	probe::Report report;
+	auto const nbRead = readFully(fds[0], &report, sizeof(report));
+	auto const firstByteTime = now();
+
+	// Drain the rest of the output so that the child never blocks on a full pipe
+	char buffer[256];
+	while (read(fds[0], buffer, sizeof(buffer)) > 0) {
+	}
+	close(fds[0]);
+
+	int status = 0;
+	rusage usage;
+	std::memset(&usage, 0, sizeof(usage));
+	wait4(pid, &status, 0, &usage);
+
+	if (nbRead != sizeof(report) || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+		return false;
+	}
+
+	// Note: Counter also includes instructions of this process between the two reads, a tiny fraction
+	sample.instructions = readCounter(counter) - instructionsBefore;
+	sample.firstByte = firstByteTime - spawnTime;
+	sample.phases[0] = report.timestamps[0] - spawnTime;
+	for (int phase = 1; phase < probe::kNbPhases; ++phase) {
+		sample.phases[phase] = report.timestamps[phase] - report.timestamps[phase - 1];
+	}
+	sample.minorFaults = static_cast<uint64>(usage.ru_minflt);
+	sample.majorFaults = static_cast<uint64>(usage.ru_majflt);
+
+	return true;
+}
+
+
+template<typename F>
+uint64 percentile(std::vector<Sample>& samples, size_t p, F&& field) {
+	std::vector<uint64> values;
+	values.reserve(samples.size());
+	for (auto const& sample : samples) {
+		values.push_back(field(sample));
+	}
+
+	auto const nth = values.begin() + (values.size() - 1) * p / 100;
+	std::nth_element(values.begin(), nth, values.end());
+	return *nth;
+}
+
+
+template<typename F>
+float64 mean(std::vector<Sample> const& samples, F&& field) {
+	float64 total = 0;
+	for (auto const& sample : samples) {
+		total += static_cast<float64>(field(sample));
+	}
+
+	return total / static_cast<float64>(samples.size());
+}
+
+
+bool run(StringView probeDir, Probe const& probe, uint32 runs, int counter) {
+	auto const path = std::string{probeDir.data(), probeDir.size()} + "/" + probe.name;
+	std::vector<char*> argv;
+	argv.push_back(const_cast<char*>(probe.name));
+	for (auto arg : probe.args) {
+		argv.push_back(const_cast<char*>(arg));
+	}
+	argv.push_back(nullptr);
+
+	std::vector<Sample> samples;
+	samples.reserve(runs);
+
+	Sample sample;
+	runOnce(path, argv, counter, sample);  // Warm up page cache
+	for (uint32 i = 0; i < runs; ++i) {
+		if (!runOnce(path, argv, counter, sample)) {
+			std::cerr << probe.name << ": probe has failed to report\n";
+			return false;
+		}
+
+		samples.push_back(sample);
+	}
+
+	std::cout << std::fixed << std::setprecision(1)
+			  << probe.name << ": " << runs << " runs, first byte p50 "
+			  << static_cast<float64>(percentile(samples, 50, [](auto& s) { return s.firstByte; })) / 1000 << "us, p99 "
+			  << static_cast<float64>(percentile(samples, 99, [](auto& s) { return s.firstByte; })) / 1000 << "us\n";
+
+	for (int phase = 0; phase < probe::kNbPhases; ++phase) {
+		std::cout << "  " << std::setw(12) << std::left << kPhaseNames[phase] << std::right << " p50 "
+				  << static_cast<float64>(percentile(samples, 50, [phase](auto& s) { return s.phases[phase]; })) / 1000
+				  << "us, p99 "
+				  << static_cast<float64>(percentile(samples, 99, [phase](auto& s) { return s.phases[phase]; })) / 1000
+				  << "us\n";
+	}
+
+	std::cout << "  " << mean(samples, [](auto& s) { return s.minorFaults; }) << " minor / "
+			  << mean(samples, [](auto& s) { return s.majorFaults; }) << " major page faults";
+	if (counter >= 0) {
+		std::cout << ", " << mean(samples, [](auto& s) { return s.instructions; }) / 1000 << "K instructions";
+	}
+	std::cout << " per run\n";
+
+	return true;
+}
+
+}  // namespace
+
+
+int main(int argc, const char** argv) {
+	uint32 runs = 2000;
+	StringView probeDir{CLIME_PROBE_DIR};
+
+	auto const res = Parser{"Process startup latency benchmark", {
+			Parser::printHelp(),
+			{{"runs"}, "Number of times to spawn each probe", &runs},
+			{{"probes"}, "Directory of the probe executables", &probeDir}
+		}}
+		.parse(argc, argv);
+
+	if (!res) {
+		auto& error = res.getError();
+		if (error) {
+			std::cerr << error << '\n';
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	Probe const probes[] = {
+		{"probe_single", {"-i", "42", "--name", "bench"}},
+		{"probe_multi", {"-i", "3", "add", "2", "3"}},
+		{"probe_large", {"c123", "--port=8080", "-r", "3", "--dry-run"}}
+	};
+
+	auto const counter = openInstructionCounter();
+	if (counter < 0) {
+		std::cerr << "Instruction counter is not available: " << std::strerror(errno) << '\n';
+	}
+
+	bool ok = true;
+	for (auto const& probe : probes) {
+		ok = run(probeDir, probe, runs, counter) && ok;
+	}
+
+	if (counter >= 0) {
+		close(counter);
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,74 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Timestamps of startup phases of a probe executable, @see bench_startup.cpp.
+ * A probe marks each phase as it completes and its action writes the timestamps to stdout
+ * as the very first bytes it outputs, so that the benchmark can tell when the action has started.
+*/
+#pragma once
+#ifndef CLIME_BENCH_STARTUP_PROBE_HPP
+#define CLIME_BENCH_STARTUP_PROBE_HPP
+
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+
+namespace probe {
+
+enum Phase {
+	kLoaded,		//!< Executable and shared objects are loaded, before static initializers of the executable.
+	kMain,			//!< Static initialization is done and main() is entered.
+	kConstructed,	//!< Parser has been constructed.
+	kParsed,		//!< Command line has been parsed.
+	kAction,		//!< Action selected by the command line has started.
+	kNbPhases
+};
+
+/// Report written by a probe: CLOCK_MONOTONIC nanoseconds of each phase.
+struct Report {
+	std::uint64_t	timestamps[kNbPhases];
+};
+
+
+inline Report report{};
+
+
+inline void mark(Phase phase) noexcept {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	report.timestamps[phase] = static_cast<std::uint64_t>(now.tv_sec) * 1000000000ULL +
+			static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+
+/// Mark start of the action and write the report. To be called first thing by an action.
+inline void actionStarted() noexcept {
+	mark(kAction);
+	auto written = write(STDOUT_FILENO, &report, sizeof(report));
+	static_cast<void>(written);  // Benchmark reports a short read
+}
+
+
+/// Runs before static initializers of the executable, which use the default priority.
+__attribute__((constructor(101))) static void markLoaded() noexcept {
+	mark(kLoaded);
+}
+
+}  // namespace probe
+#endif  // CLIME_BENCH_STARTUP_PROBE_HPP
@@ -0,0 +1,97 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Startup probe with a large schema: 400 sub-commands with eight options each.
+*/
+
+#include "probe.hpp"
+
+#include <clime/parser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <cstdio>
+#include <iostream>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+constexpr int kNbCommands = 400;
+
+/// Names are fixed width so that they fill char arrays.
+char commandNames[kNbCommands][5];
+
+
+struct Settings {
+	bool	verbose{false};
+	bool	dryRun{false};
+	int32	retries{0};
+	uint32	timeout{0};
+	uint16	port{0};
+	StringView	host;
+	StringView	user;
+	float64	ratio{0};
+};
+
+Settings settings;
+
+
+Result<void, Error> run() {
+	probe::actionStarted();
+	std::cout << "port " << settings.port << ", retries " << settings.retries << '\n';
+
+	return Ok();
+}
+
+}  // namespace
+
+
+int main(int argc, const char **argv) {
+	probe::mark(probe::kMain);
+
+	using Option = Parser::Option;
+	auto& s = settings;
+	auto parser = Parser{"clime: large schema startup probe"};
+	for (int i = 0; i < kNbCommands; ++i) {
+		std::snprintf(commandNames[i], sizeof(commandNames[i]), "c%03d", i);
+		parser.addCommand(commandNames[i], "Command", run)
+			.options(Option{{"v", "verbose"}, "Verbose output", &s.verbose},
+					 Option{{"n", "dry-run"}, "Do nothing", &s.dryRun},
+					 Option{{"r", "retries"}, "Number of retries", &s.retries},
+					 Option{{"t", "timeout"}, "Timeout", &s.timeout},
+					 Option{{"p", "port"}, "Port", &s.port},
+					 Option{{"H", "host"}, "Host", &s.host},
+					 Option{{"u", "user"}, "User", &s.user},
+					 Option{{"ratio"}, "Ratio", &s.ratio});
+	}
+	probe::mark(probe::kConstructed);
+
+	auto res = parser.parse(argc, argv);
+	probe::mark(probe::kParsed);
+
+	if (!res) {
+		std::cerr << res.getError() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	res.unwrap()();
+	return EXIT_SUCCESS;
+}
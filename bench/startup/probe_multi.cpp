@@ -0,0 +1,108 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * Startup probe modelled on examples/cli_multi.cpp: a multi-action CLI.
+*/
+
+#include "probe.hpp"
+
+#include <clime/parser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <iostream>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+static constexpr StringLiteral      kAppName = "probe_multi";
+static const Version                kAppVersion = Version(0, 0, 1, "dev");
+
+
+static uint intValue = 3;
+static float32 floatValue = 0.0f;
+static StringView userName{getenv("USER")};
+
+
+Result<void, Error> sayHi() {
+	probe::actionStarted();
+	std::cout << "Hello '" << userName << "'" << '\n';
+
+	return Ok();
+}
+
+Result<void, Error> list() {
+	probe::actionStarted();
+	for (uint i = 0; i < intValue; ++i) {
+		std::cout << " - " << i << '\n';
+	}
+
+	return Ok();
+}
+
+
+static int addArg_1 = 0;
+static int addArg_2 = 0;
+
+Result<void, Error>
+addNumbers() {
+	probe::actionStarted();
+	std::cout << addArg_1 << " + " << addArg_2 << " = " << addArg_1 + addArg_2 << '\n';
+
+	return Ok();
+}
+
+
+int main(int argc, const char **argv) {
+	probe::mark(probe::kMain);
+
+	auto parser = Parser("clime: multi action startup probe", {
+				Parser::printHelp(),
+				Parser::printVersion(kAppName, kAppVersion),
+
+				{{"i", "listCounter"},	"Listing size", &intValue},
+				{{"fOption"},			"Foating point value for the demo", &floatValue},
+				{{"u", "name"},			"Greet user name", &userName}
+			});
+	parser.commands({
+				{"greet-1", {"Say Hi to the user", sayHi}},
+				{"count", {"Print n numbers", list}},
+				{"add",	{"Add numbers", {
+							{"arg1", "1st argument", &addArg_1},
+							{"arg2", "2nd argument", &addArg_2}
+						},
+						addNumbers}}
+			});
+	probe::mark(probe::kConstructed);
+
+	auto res = parser.parse(argc, argv);
+	probe::mark(probe::kParsed);
+
+	if (!res) {
+		auto& error = res.getError();
+		if (error) {
+			std::cerr << res.getError().toString() << '\n';
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	res.unwrap()();  // Do the selected action.
+	return EXIT_SUCCESS;
+}
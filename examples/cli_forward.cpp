@@ -0,0 +1,47 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+
+/**
+ * An example of a client shim forwarding its command line to a command server.
+ * Usage: cli_forward <socket path> <program name> [arguments...]
+*/
+
+#include <clime/extras/commandServer.hpp>
+#include <solace/output_utils.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+int main(int argc, const char **argv) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " <socket path> <program name> [arguments...]\n";
+		return EXIT_FAILURE;
+	}
+
+	auto const args = arrayView(argv + 2, static_cast<size_t>(argc - 2));
+	auto status = extras::forwardCommand(argv[1], args, std::cout);
+	if (!status) {
+		std::cerr << status.getError() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return status.unwrap();
+}
@@ -0,0 +1,223 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/choices.hpp
+ *	@brief		Compile-time tables mapping choice names to enum values.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_CHOICES_HPP
+#define CLIME_CHOICES_HPP
+
+#include <solace/stringView.hpp>
+#include <solace/arrayView.hpp>
+#include <solace/optional.hpp>
+
+#include <array>
+#include <cassert>
+
+
+namespace clime {
+
+/// A single named value of a choice option.
+template<typename E>
+struct Choice {
+	Solace::StringLiteral	name;
+	E						value;
+};
+
+
+namespace detail {
+
+/// Seeded FNV-1a hash of a choice name.
+constexpr Solace::uint32
+choiceHash(Solace::StringView name, Solace::uint32 seed) noexcept {
+	Solace::uint32 hash = (2166136261u ^ seed) * 16777619u;
+	for (Solace::StringView::size_type i = 0; i < name.size(); ++i) {
+		hash = (hash ^ static_cast<Solace::uint8>(name.data()[i])) * 16777619u;
+	}
+
+	return hash ^ (hash >> 15);
+}
+
+
+constexpr bool
+isSameName(Solace::StringView lhs, Solace::StringView rhs) noexcept {
+	if (lhs.size() != rhs.size()) {
+		return false;
+	}
+
+	for (Solace::StringView::size_type i = 0; i < lhs.size(); ++i) {
+		if (lhs.data()[i] != rhs.data()[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/// Number of hash slots for a table of n choices: a power of two with load factor of at most 1/4.
+constexpr size_t
+choiceSlots(size_t n) noexcept {
+	size_t slots = 4;
+	while (slots < 4 * n) {
+		slots *= 2;
+	}
+
+	return slots;
+}
+
+}  // namespace detail
+
+
+/**
+ * Table of named values of a choice option, such as `--mode=fast|safe|audit`.
+ *
+ * The table is meant to be built at compile time:
+ * \code
+ *   static constexpr auto kModes = makeChoices<Mode>({{"fast", Mode::Fast}, {"safe", Mode::Safe}});
+ * \endcode
+ * Construction searches for a hash seed that maps every name into a distinct slot,
+ * so a lookup costs a single hash and at most one string compare.
+ * Names must be unique: a duplicate could never be looked up, so debug builds reject it,
+ * at compile time for a constexpr table. If no seed is found, lookups fall back to a linear search.
+ */
+template<typename E, size_t N>
+class ChoiceTable {
+public:
+	static_assert(N > 0, "Choice table must not be empty");
+	static_assert(N < 0xFF, "Too many choices");
+
+	using size_type = Solace::uint32;
+
+	/// Number of hash slots in the table.
+	static constexpr size_t kSlots = detail::choiceSlots(N);
+
+	constexpr explicit ChoiceTable(Choice<E> const (&choices)[N]) noexcept {
+		for (size_t i = 0; i < N; ++i) {
+			_names[i] = choices[i].name;
+			_values[i] = choices[i].value;
+		}
+
+		assert(hasUniqueNames() && "Duplicate choice name");
+
+		for (Solace::uint32 seed = 1; seed <= kMaxSeeds; ++seed) {
+			if (tryBuild(seed)) {
+				_seed = seed;
+				return;
+			}
+		}
+	}
+
+	/// Number of choices in the table.
+	constexpr size_type size() const noexcept { return N; }
+
+	/// Check if lookups are done using a perfect hash.
+	constexpr bool isPerfect() const noexcept { return _seed != 0; }
+
+	/**
+	 * Find index of a choice by its name.
+	 * @param name Name of the choice to find.
+	 * @return Index of the choice or size() if there is no choice with the given name.
+	 */
+	constexpr size_type indexOf(Solace::StringView name) const noexcept {
+		if (_seed == 0) {
+			for (size_type i = 0; i < N; ++i) {
+				if (detail::isSameName(_names[i], name)) {
+					return i;
+				}
+			}
+
+			return N;
+		}
+
+		auto const slot = _slots[detail::choiceHash(name, _seed) & (kSlots - 1)];
+		return (slot != kEmptySlot && detail::isSameName(_names[slot], name))
+				? slot
+				: N;
+	}
+
+	/// Find value of a choice by its name.
+	Solace::Optional<E> find(Solace::StringView name) const noexcept {
+		auto const index = indexOf(name);
+		if (index == N) {
+			return Solace::none;
+		}
+
+		return Solace::Optional<E>{_values[index]};
+	}
+
+	constexpr Solace::StringLiteral name(size_type index) const noexcept { return _names[index]; }
+	constexpr E value(size_type index) const noexcept { return _values[index]; }
+
+	/// Names of all the choices, in the order given to the constructor.
+	Solace::ArrayView<const Solace::StringLiteral> names() const noexcept {
+		return Solace::arrayView(_names.data(), _names.size());
+	}
+
+private:
+	static constexpr Solace::uint8 kEmptySlot = 0xFF;
+	static constexpr Solace::uint32 kMaxSeeds = 4096;
+
+	constexpr bool hasUniqueNames() const noexcept {
+		for (size_t i = 0; i < N; ++i) {
+			for (size_t j = i + 1; j < N; ++j) {
+				if (detail::isSameName(_names[i], _names[j])) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	constexpr bool tryBuild(Solace::uint32 seed) noexcept {
+		for (auto& slot : _slots) {
+			slot = kEmptySlot;
+		}
+
+		for (size_t i = 0; i < N; ++i) {
+			auto& slot = _slots[detail::choiceHash(_names[i], seed) & (kSlots - 1)];
+			if (slot != kEmptySlot) {
+				return false;
+			}
+
+			slot = static_cast<Solace::uint8>(i);
+		}
+
+		return true;
+	}
+
+private:
+	std::array<Solace::StringLiteral, N>	_names{};
+	std::array<E, N>						_values{};
+	std::array<Solace::uint8, kSlots>		_slots{};
+
+	/// Seed of the perfect hash, 0 if none has been found.
+	Solace::uint32							_seed{0};
+};
+
+
+/// Build a choice table, deducing its size from the list of choices.
+template<typename E, size_t N>
+constexpr ChoiceTable<E, N>
+makeChoices(Choice<E> const (&choices)[N]) noexcept {
+	return ChoiceTable<E, N>{choices};
+}
+
+}  // End of namespace clime
+#endif  // CLIME_CHOICES_HPP
@@ -0,0 +1,93 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/diagnostics.hpp
+ *	@brief		Bounded list of errors collected by a tolerant parse.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_DIAGNOSTICS_HPP
+#define CLIME_DIAGNOSTICS_HPP
+
+#include "errorCategory.hpp"
+
+#include <solace/arrayView.hpp>
+
+#include <vector>
+
+
+namespace clime {
+
+/**
+ * Bounded list of errors collected by a tolerant parse, @see Parser::validate().
+ *
+ * Memory for the errors is reserved once, so a list can be cleared and reused to validate
+ * any number of command lines without allocations. Errors past the capacity are counted but not kept.
+ */
+class Diagnostics {
+public:
+	using size_type = Solace::uint32;
+
+	/// Default maximum number of errors kept.
+	static constexpr size_type kDefaultCapacity = 32;
+
+	explicit Diagnostics(size_type capacity = kDefaultCapacity)
+		: _capacity{capacity}
+	{
+		_errors.reserve(capacity);
+	}
+
+	/// Add an error to the list. The error is only counted if the list is full.
+	void report(Error const& error) noexcept {
+		_total += 1;
+		if (_errors.size() < _capacity) {
+			_errors.push_back(error);
+		}
+	}
+
+	/// Errors kept, in the order they have been found.
+	Solace::ArrayView<const Error> errors() const noexcept {
+		return Solace::arrayView(_errors.data(), _errors.size());
+	}
+
+	/// Number of errors kept.
+	size_type size() const noexcept { return static_cast<size_type>(_errors.size()); }
+
+	/// Number of errors reported, including the ones that have not been kept.
+	size_type total() const noexcept { return _total; }
+
+	/// Maximum number of errors kept.
+	size_type capacity() const noexcept { return _capacity; }
+
+	bool empty() const noexcept { return _total == 0; }
+
+	/// Check if some of the errors reported have not been kept.
+	bool isTruncated() const noexcept { return _total > _errors.size(); }
+
+	/// Forget all the errors, keeping the memory to reuse the list.
+	void clear() noexcept {
+		_errors.clear();
+		_total = 0;
+	}
+
+private:
+	std::vector<Error>	_errors;
+	size_type			_capacity;
+	size_type			_total{0};
+};
+
+}  // End of namespace clime
+#endif  // CLIME_DIAGNOSTICS_HPP
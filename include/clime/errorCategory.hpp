@@ -37,12 +37,96 @@ enum class ParserError : int {
 
 	InvalidInput,
 	OptionParsing,
+
+	Cancelled,			/// Action has been cancelled before completion.
+	MissingOption,		/// Option required by a constraint has not been given.
+	ConflictingOptions,	/// Options excluded by a constraint have been given together.
+};
+
+
+/// Kind of value an option or an argument expects, reported with conversion errors.
+enum class ValueKind : Solace::uint8 {
+	Unknown = 0,		/// Custom value type, or the error is not about a value.
+	Flag,
+	Integer,
+	Unsigned,
+	Float,
+	String,
+	Duration,
+	ByteSize,
+	Timestamp,
+	Choice
+};
+
+
+/**
+ * Position of a parse error in the command line, decoded from an Error.
+ * Plain data referring to argv: the token span is valid as long as argv is.
+ */
+struct ParserErrorInfo {
+	/// Argv index of an error which position is unknown.
+	static constexpr Solace::uint32 kNoPosition = ~Solace::uint32{0};
+
+	/// Error code without position payload.
+	ParserError			code;
+
+	/// Kind of the value expected.
+	ValueKind			expected;
+
+	/// Index of the argv token the error refers to, kNoPosition if unknown.
+	Solace::uint32		argvIndex;
+
+	/// Failing part of the token, empty if unknown.
+	Solace::StringView	token;
 };
 
 
 Error
 makeParserError(ParserError errorCode, Solace::StringView tag) noexcept;
 
+/**
+ * Make an error positioned in the command line.
+ * The code, expected value kind and argv index are packed into the error code,
+ * and the tag is the failing span of the argv token itself, so no memory is allocated.
+ *
+ * Breaking change: Error::value() of a positioned error is no longer the plain ParserError code.
+ * The parser reports conversion and argument count errors this way, so code comparing Error::value()
+ * against a ParserError must use parserErrorCode() instead. Errors with the same code at different
+ * positions no longer compare equal: compare parserErrorCode() of both to match on the code only.
+ * @param errorCode Error code.
+ * @param argvIndex Index of the failing argv token. Positions past 0x7FFE are reported as unknown.
+ * @param token Failing span of the argv token.
+ * @param expected Kind of value expected.
+ */
+Error
+makeParserError(ParserError errorCode,
+				Solace::uint32 argvIndex,
+				Solace::StringView token,
+				ValueKind expected = ValueKind::Unknown) noexcept;
+
+/// Get the code of a parser error without position payload. Codes of errors in other domains are returned as is.
+ParserError
+parserErrorCode(Error const& error) noexcept;
+
+/// Decode position of a parse error. Errors created without a position have argvIndex of kNoPosition.
+ParserErrorInfo
+parserErrorInfo(Error const& error) noexcept;
+
+/// Static message of an error code.
+Solace::StringLiteral
+parserErrorMessage(ParserError errorCode) noexcept;
+
+/**
+ * Format a message of an error into a buffer, such as "argv[2] '--port=x8': error parsing option value (integer)".
+ * Nothing is allocated, so errors can be reported at the rate of validation.
+ * @param error Error to format.
+ * @param buffer Buffer to write NUL-terminated message into. The message is truncated to fit.
+ * @param size Size of the buffer in bytes.
+ * @return Length of the full message, as snprintf(3) does.
+ */
+size_t
+formatParserError(Error const& error, char* buffer, size_t size) noexcept;
+
 
 }  // End of namespace clime
 #endif  // CLIME_ERRORCATEGORY_HPP
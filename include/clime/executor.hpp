@@ -0,0 +1,92 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/executor.hpp
+ *	@brief		Executor interface and cancellation used to dispatch command actions.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXECUTOR_HPP
+#define CLIME_EXECUTOR_HPP
+
+#include "errorCategory.hpp"
+
+#include <solace/result.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+
+namespace clime {
+
+/**
+ * Executor runs tasks on behalf of a command action.
+ * Implemented by the application to plug in its own event loop or thread pool.
+ */
+class Executor {
+public:
+	using Task = std::function<void()>;
+
+	virtual ~Executor() = default;
+
+	/// Schedule a task to be executed. Tasks must not be dropped.
+	virtual void post(Task task) = 0;
+};
+
+
+/**
+ * Executor that runs tasks immediately in the calling thread.
+ */
+class InlineExecutor final : public Executor {
+public:
+	void post(Task task) override {
+		task();
+	}
+};
+
+
+/**
+ * Cancellation token shared by a dispatcher and an action.
+ * Cancellation is cooperative: an action is expected to check the token at convenient points
+ * and complete with an error as soon as possible once cancelled.
+ */
+class CancellationToken {
+public:
+
+	CancellationToken()
+		: _cancelled{std::make_shared<std::atomic<bool>>(false)}
+	{}
+
+	/// Request cancellation of all the actions holding a copy of this token.
+	void cancel() const noexcept {
+		_cancelled->store(true, std::memory_order_release);
+	}
+
+	bool isCancelled() const noexcept {
+		return _cancelled->load(std::memory_order_acquire);
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool>>	_cancelled;
+};
+
+
+/// Handler called exactly once with the result of an action.
+using Completion = std::function<void(Solace::Result<void, Error>)>;
+
+}  // End of namespace clime
+#endif  // CLIME_EXECUTOR_HPP
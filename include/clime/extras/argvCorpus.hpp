@@ -0,0 +1,120 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/argvCorpus.hpp
+ *	@brief		Corpus of captured command lines to replay through a parser.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_ARGVCORPUS_HPP
+#define CLIME_EXTRAS_ARGVCORPUS_HPP
+
+#include "clime/parser.hpp"
+
+#include <vector>
+
+
+namespace clime::extras {
+
+/// Environment variable naming the corpus file captureArgv() appends to.
+constexpr char const kArgvCorpusEnv[] = "CLIME_ARGV_CORPUS";
+
+
+/**
+ * Corpus of command lines, such as the ones captured from real invocations of a tool.
+ *
+ * A corpus file is a sequence of records, one per command line:
+ * number of tokens and size of the tokens in bytes, both as native uint32,
+ * followed by the tokens, each terminated by a NUL.
+ * Records are self-contained, so any number of processes can append to the same file.
+ */
+class ArgvCorpus {
+public:
+	using size_type = Solace::uint32;
+
+	/**
+	 * Read a corpus file.
+	 * @param path Path to the corpus file.
+	 * @return Corpus or an error tagged with the path if the file can't be read or is malformed.
+	 */
+	static Solace::Result<ArgvCorpus, Error> load(Solace::StringView path);
+
+	/**
+	 * Decode records of a corpus file.
+	 * @param data Content of a corpus file. It is copied into the corpus.
+	 * @return Corpus or an error if the data is malformed.
+	 */
+	static Solace::Result<ArgvCorpus, Error> decode(Solace::StringView data);
+
+	/// Add a command line to the corpus.
+	void append(Solace::ArrayView<const char*> args);
+
+	/**
+	 * Write the corpus into a file, replacing its content.
+	 * @param path Path to the corpus file.
+	 * @return Error tagged with the path if the file can't be written.
+	 */
+	Solace::Result<void, Error> save(Solace::StringView path) const;
+
+	/// Number of command lines in the corpus.
+	size_type size() const noexcept { return static_cast<size_type>(_records.size() - 1); }
+
+	bool empty() const noexcept { return size() == 0; }
+
+	/// Get a command line of the corpus, ready to be given to Parser::parse().
+	Solace::ArrayView<const char*> operator[] (size_type index) const noexcept {
+		// Note: Parser takes a view of non-const pointers, but never modifies them
+		auto const argv = const_cast<const char**>(_argv.data());
+		return Solace::arrayView(argv + _records[index], _records[index + 1] - _records[index]);
+	}
+
+private:
+	/// Tokens of all the command lines, each terminated by a NUL.
+	std::vector<char>			_tokens;
+
+	/// Offsets of the tokens, to rebuild pointers into _tokens once it has grown.
+	std::vector<size_type>		_offsets;
+
+	/// Pointers to the tokens, in order.
+	std::vector<const char*>	_argv;
+
+	/// Index of the first token of each command line, followed by the total number of tokens.
+	std::vector<size_type>		_records{0};
+};
+
+
+/**
+ * Append a command line to a corpus file, creating the file if needed.
+ * A record is written with a single write to a file opened for appending,
+ * so records of processes capturing concurrently don't interleave.
+ * @param path Path to the corpus file.
+ * @param args Command line arguments, including name of the program.
+ * @return Error tagged with the path if the record can't be written.
+ */
+Solace::Result<void, Error>
+appendToCorpus(Solace::StringView path, Solace::ArrayView<const char*> args);
+
+
+/**
+ * Capture hook to call with argv at the start of main():
+ * appends the command line to the corpus file named by CLIME_ARGV_CORPUS environment variable, if it is set.
+ * Capture must never stop a tool from running, so errors are ignored.
+ * @param args Command line arguments, including name of the program.
+ */
+void captureArgv(Solace::ArrayView<const char*> args) noexcept;
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_ARGVCORPUS_HPP
@@ -0,0 +1,104 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/commandChain.hpp
+ *	@brief		Running several commands given in a single command line.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_COMMANDCHAIN_HPP
+#define CLIME_EXTRAS_COMMANDCHAIN_HPP
+
+#include "clime/parser.hpp"
+
+#include <vector>
+
+
+namespace clime::extras {
+
+/// Separator of command segments that may run concurrently.
+constexpr Solace::StringLiteral kConcurrentSeparator{"--"};
+
+/// Separator of command segments that run in order: segments after it start once all before it have succeeded.
+constexpr Solace::StringLiteral kSequentialSeparator{"::"};
+
+
+/**
+ * A single command segment of a chained command line.
+ */
+struct ChainSegment {
+	using size_type = Solace::uint32;
+
+	/// Command line of the segment: name of the program followed by tokens of the segment.
+	std::vector<const char*>	args;
+
+	/// Index of the group of segments. Segments of the same group run concurrently, groups run in order.
+	size_type					group{0};
+
+	/// Error parsing or running the segment. None if the segment has completed successfully.
+	Solace::Optional<Error>		error;
+};
+
+
+/**
+ * Split command line into command segments.
+ * @param args Command line arguments, including name of the program.
+ * @return Segments of the command line in the order given.
+ */
+std::vector<ChainSegment>
+splitChain(Solace::ArrayView<const char*> args);
+
+
+/**
+ * Parse a chained command line and run all of its commands.
+ *
+ * Command line is split into segments with separators:
+ *  `tool build x -- build-docs :: deploy y -- notify`
+ * runs `build x` and `build-docs` concurrently, then, if both have succeeded, `deploy y` and `notify` concurrently.
+ *
+ * All the segments are parsed before any action runs, so a typo in the last segment does not leave
+ * the first ones executed. Each group is re-parsed right before it runs,
+ * so variables bound by options hold values given in the running segments.
+ * As segments of a group run concurrently and share bound variables, neither a command nor an option
+ * may be given to more than one segment of a group: use the sequential separator for that.
+ *
+ * @param parser Parser to parse segments with.
+ * @param args Command line arguments, including name of the program.
+ * @param executor Executor to run actions on. Use an InlineExecutor to run all segments sequentially.
+ * @param cancellation Token to cancel the chain. Segments that have not started are not run.
+ * @return Segments with errors of the segments that have failed, or have not been run due to failures.
+ */
+std::vector<ChainSegment>
+runChain(Parser const& parser,
+		 Solace::ArrayView<const char*> args,
+		 Executor& executor,
+		 CancellationToken const& cancellation = {});
+
+
+/// Check if all the segments of a chain have completed successfully.
+inline bool
+isSuccessful(std::vector<ChainSegment> const& segments) noexcept {
+	for (auto const& segment : segments) {
+		if (segment.error) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_COMMANDCHAIN_HPP
@@ -0,0 +1,236 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/commandServer.hpp
+ *	@brief		Persistent server executing command lines with a resident parser.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_COMMANDSERVER_HPP
+#define CLIME_EXTRAS_COMMANDSERVER_HPP
+
+#include "clime/parser.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace clime::extras {
+
+/**
+ * Result of a command executed by a server.
+ */
+struct CommandResponse {
+	/// Exit status of the command, as a process would have returned from main.
+	int				status{0};
+
+	/// Output the command has written to std::cout and std::cerr.
+	std::string		output;
+};
+
+
+/**
+ * Frame protocol used by command server and clients.
+ *
+ * Request frame is NUL-delimited argv with number of arguments given first:
+ *   <argc>\0<argv[0]>\0<argv[1]>\0 ... <argv[argc-1]>\0
+ * Response frame is exit status and length of the output followed by captured output:
+ *   <status>\0<length>\0<output bytes>
+ * Numbers are in decimal text form, so a request can be produced with printf.
+ */
+class FrameReader {
+public:
+	using size_type = Solace::uint32;
+
+	/// Maximum number of arguments in a request frame.
+	static constexpr size_type kMaxArgs = 4096;
+
+	/// Maximum size of a frame in bytes.
+	static constexpr size_type kMaxFrameSize = 16 * 1024 * 1024;
+
+	/**
+	 * Construct a reader.
+	 * @param fd File descriptor to read frames from. Reader does not own the descriptor.
+	 */
+	explicit FrameReader(int fd) noexcept
+		: _fd{fd}
+	{}
+
+	/**
+	 * Read next request frame.
+	 * @param args Pointers to the arguments. Valid until the next read.
+	 * @return True if a frame has been read, false on EOF before the frame, or an error.
+	 */
+	Solace::Result<bool, Error> readRequest(std::vector<const char*>& args);
+
+	/**
+	 * Read next response frame.
+	 * @return Command response or an error.
+	 */
+	Solace::Result<CommandResponse, Error> readResponse();
+
+private:
+
+	/// Read next NUL-terminated token, returning offset of the token in the buffer.
+	Solace::Result<Solace::Optional<size_type>, Error> nextToken();
+
+	/// Read next token as a decimal number.
+	Solace::Result<Solace::Optional<size_type>, Error> nextNumber(size_type maxValue);
+
+	/// Read more data from the file descriptor.
+	Solace::Result<bool, Error> fill();
+
+private:
+	int				_fd;
+	std::string		_buffer;
+
+	/// Offset of the first unconsumed byte in the buffer.
+	size_type		_position{0};
+};
+
+
+/// Write a request frame.
+Solace::Result<void, Error>
+writeRequest(int fd, Solace::ArrayView<const char*> args);
+
+/// Write a response frame.
+Solace::Result<void, Error>
+writeResponse(int fd, CommandResponse const& response);
+
+
+/**
+ * Create a Unix domain socket listening for connections.
+ * The socket is only accessible to the user of the process (mode 0600), as requests run with its privileges.
+ * A stale socket file left at the path by a previous server instance is removed,
+ * while the socket of a server that is still running is not: creating the socket fails.
+ * @param socketPath Path of the socket to create.
+ * @return File descriptor of the listening socket or an error.
+ */
+Solace::Result<int, Error>
+listenUnixSocket(Solace::StringView socketPath);
+
+
+/**
+ * Parse a command line and run the selected action.
+ * Errors are written to std::cerr. Help and version requests are not considered to be errors.
+ * @param parser Parser to use.
+ * @param args Command line arguments, including name of the program.
+ * @return Exit status, as a process would have returned from main.
+ */
+int dispatchCommand(Parser const& parser, Solace::ArrayView<const char*> args);
+
+
+/**
+ * Command server keeps a constructed parser resident to execute command lines sent by clients,
+ * avoiding cost of a process start, dynamic linking and parser construction per invocation.
+ *
+ * Requests are read from a stream (such as stdin) or from connections to a Unix domain socket.
+ * For each request the server parses given argv, dispatches selected action
+ * and responds with the exit status and the output the action has written to std::cout / std::cerr.
+ *
+ * Connections are served by a pool of workers, which only overlaps socket IO of the clients:
+ * dispatch is serialized, one request at a time. Parser options are bound to shared variables,
+ * and output is captured by redirecting global std::cout / std::cerr for the duration of the request,
+ * so output written by other threads of the process while a request is executing ends up in its response.
+ * Bound variables retain values from the previous request,
+ * a reset callback is given a chance to restore defaults before each request.
+ *
+ * \code{.cpp}
+ auto server = CommandServer{parser, []() { settings = Settings{}; }};
+ if (serverMode) {
+	return server.listen(socketPath) ? EXIT_SUCCESS : EXIT_FAILURE;
+ }
+ \endcode
+ */
+class CommandServer {
+public:
+	using ResetCallback = std::function<void()>;
+	using size_type = Solace::uint32;
+
+	CommandServer(CommandServer const&) = delete;
+	CommandServer& operator= (CommandServer const&) = delete;
+
+	/**
+	 * Construct a server.
+	 * @param parser Parser to use for requests. Must outlive the server.
+	 * @param reset Callback to restore default values of the bound variables before each request.
+	 */
+	explicit CommandServer(Parser const& parser, ResetCallback reset = {})
+		: _parser{parser}
+		, _reset{Solace::mv(reset)}
+	{}
+
+	/**
+	 * Execute a single command line.
+	 * An exception thrown by the action is reported as EXIT_FAILURE status with its message in the output.
+	 * @param args Command line arguments, including name of the program.
+	 * @return Exit status and output of the command.
+	 */
+	CommandResponse execute(Solace::ArrayView<const char*> args);
+
+	/**
+	 * Serve requests from a stream until EOF.
+	 * @param inFd File descriptor to read requests from, for example stdin.
+	 * @param outFd File descriptor to write responses to, for example stdout.
+	 * @return Error if stream IO failed.
+	 */
+	Solace::Result<void, Error> serve(int inFd, int outFd);
+
+	/**
+	 * Listen for connections on a Unix domain socket and serve them until stop() is called.
+	 * @param socketPath Path of the socket to create.
+	 * @param nbWorkers Number of connections to serve concurrently. Zero means number of hardware threads.
+	 * @return Error if the socket can not be created.
+	 */
+	Solace::Result<void, Error> listen(Solace::StringView socketPath, size_type nbWorkers = 0);
+
+	/**
+	 * Stop listening for new connections. Connections already accepted are served to completion.
+	 * May be called from any thread. If no listen() is in progress, the next one returns
+	 * as soon as the socket has been created.
+	 */
+	void stop() noexcept;
+
+private:
+	Parser const&			_parser;
+	ResetCallback			_reset;
+
+	/// Serializes parsing and dispatch of requests.
+	std::mutex				_dispatchLock;
+
+	/// Guards listening socket descriptor against concurrent stop().
+	std::mutex				_listenLock;
+	int						_listenFd{-1};
+	std::atomic<bool>		_stopping{false};
+};
+
+
+/**
+ * Client side shim: forward a command line to a command server and copy its output.
+ * @param socketPath Path of the Unix domain socket the server is listening on.
+ * @param args Command line arguments, including name of the program.
+ * @param output Stream to copy output of the command to.
+ * @return Exit status of the command, or an error if the server can not be reached.
+ */
+Solace::Result<int, Error>
+forwardCommand(Solace::StringView socketPath, Solace::ArrayView<const char*> args, std::ostream& output);
+
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_COMMANDSERVER_HPP
@@ -0,0 +1,106 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/forkServer.hpp
+ *	@brief		Fork-server (zygote) executing each command line in a forked child process.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_FORKSERVER_HPP
+#define CLIME_EXTRAS_FORKSERVER_HPP
+
+#include "clime/extras/commandServer.hpp"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <mutex>
+
+
+namespace clime::extras {
+
+/**
+ * Fork-server (zygote) for CLIs with expensive initialization.
+ *
+ * A pre-initialized parent process listens on a Unix domain socket and forks a child for each connection.
+ * The child reads request argv, parses it and runs the selected action with the parent's memory shared copy-on-write,
+ * so the cost of initialization is paid once and each request only pays for a fork.
+ * Actions are free to mutate global state as it never leaks back into the parent or into other requests.
+ *
+ * The protocol is the same as for the CommandServer, @see FrameReader, so forwardCommand() can be used as a client.
+ * Output is captured on the file descriptor level in the child, so it includes anything written to stdout / stderr.
+ *
+ * Note that only the thread calling fork is replicated in a child, so the parent should not rely
+ * on other threads (or locks they may hold) being available to actions.
+ */
+class ForkServer {
+public:
+
+	ForkServer(ForkServer const&) = delete;
+	ForkServer& operator= (ForkServer const&) = delete;
+
+	/**
+	 * Construct a fork server.
+	 * @param parser Fully constructed parser to be inherited by children.
+	 */
+	explicit ForkServer(Parser const& parser) noexcept
+		: _parser{parser}
+	{}
+
+	/**
+	 * Listen for connections on a Unix domain socket and fork a child for each until stop() is called.
+	 * @param socketPath Path of the socket to create.
+	 * @return Error if the socket can not be created.
+	 */
+	Solace::Result<void, Error> listen(Solace::StringView socketPath);
+
+	/**
+	 * Fork a child to serve a single request from the given connection.
+	 * The connection is closed in the parent process.
+	 * @param connection Connected socket to read request from and write response to.
+	 * @return Process id of the child or an error.
+	 */
+	Solace::Result<pid_t, Error> spawn(int connection);
+
+	/**
+	 * Stop listening for new connections. Running children are waited for before listen() returns.
+	 * May be called from any thread. If no listen() is in progress, the next one returns
+	 * as soon as the socket has been created.
+	 */
+	void stop() noexcept;
+
+private:
+
+	/// Serve the request in the child process. Never returns: an exception thrown by the action fails the child.
+	[[noreturn]] void serveInChild(int connection);
+
+	/// Collect exit status of finished children.
+	void reapChildren(bool wait) noexcept;
+
+private:
+	Parser const&			_parser;
+
+	/// Children that are still running. Only accessed by the listening thread.
+	std::vector<pid_t>		_children;
+
+	/// Guards listening socket descriptor against concurrent stop().
+	std::mutex				_listenLock;
+	int						_listenFd{-1};
+	std::atomic<bool>		_stopping{false};
+};
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_FORKSERVER_HPP
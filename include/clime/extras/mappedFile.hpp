@@ -0,0 +1,155 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/mappedFile.hpp
+ *	@brief		Input file arguments opened and memory mapped at parse time.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_MAPPEDFILE_HPP
+#define CLIME_EXTRAS_MAPPEDFILE_HPP
+
+#include "clime/parser.hpp"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace clime::extras {
+
+/**
+ * Read-only memory mapping of an input file.
+ *
+ * A file is mapped as soon as it is opened and the kernel is advised that the whole file will be needed,
+ * so reading of the file from disk overlaps with the rest of the application startup.
+ */
+class MappedFile {
+public:
+	using size_type = Solace::StringView::size_type;
+
+	~MappedFile();
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator= (MappedFile const&) = delete;
+
+	MappedFile() noexcept = default;
+
+	MappedFile(MappedFile&& rhs) noexcept
+		: _data{std::exchange(rhs._data, nullptr)}
+		, _size{std::exchange(rhs._size, 0)}
+		, _path{std::exchange(rhs._path, Solace::StringView{})}
+	{}
+
+	MappedFile& operator= (MappedFile&& rhs) noexcept {
+		return swap(rhs);
+	}
+
+	MappedFile& swap(MappedFile& rhs) noexcept {
+		using std::swap;
+		swap(_data, rhs._data);
+		swap(_size, rhs._size);
+		swap(_path, rhs._path);
+
+		return *this;
+	}
+
+	/**
+	 * Open and map a file.
+	 * @param path Path to the file to open. Must remain valid while the mapping is used.
+	 * @return Mapped file or an error tagged with the path. Files of 4GiB or more are rejected with EFBIG,
+	 * as their content can not be viewed as a StringView.
+	 */
+	static Solace::Result<MappedFile, Error> open(Solace::StringView path);
+
+	/// Check if a file is mapped.
+	bool isOpen() const noexcept { return !_path.empty(); }
+
+	/// Path of the mapped file.
+	Solace::StringView path() const noexcept { return _path; }
+
+	/// Content of the file.
+	Solace::StringView view() const noexcept {
+		return {static_cast<char const*>(_data), _size};
+	}
+
+	/// Size of the file in bytes.
+	size_type size() const noexcept { return _size; }
+
+private:
+	void*				_data{nullptr};
+	size_type			_size{0};
+	Solace::StringView	_path;
+};
+
+
+inline void swap(MappedFile& lhs, MappedFile& rhs) noexcept { lhs.swap(rhs); }
+
+
+/**
+ * Option and argument callback opening and mapping a file given on a command line.
+ * Failure to open a file is a parse error, tagged with the path.
+ * A file bound to a vector is appended, so the callback can be used for a trailing argument.
+ *
+ * \code{.cpp}
+ MappedFile dictionary;
+ std::vector<MappedFile> inputs;
+
+ Parser{"Word counter", {
+		{{"d", "dictionary"}, "Dictionary", Parser::ArgumentValue::Required, mapFileInto(&dictionary)}
+	}}
+	.arguments({
+		{"*", "Input files", mapFileInto(&inputs)}
+	});
+ \endcode
+ */
+template<typename Dest>
+struct MapFileInto {
+	static_assert(std::is_same_v<Dest, MappedFile> || std::is_same_v<Dest, std::vector<MappedFile>>,
+				  "Files can only be mapped into a MappedFile or a vector of them");
+
+	Solace::Optional<Error>
+	operator() (Solace::StringView path, Parser::Context const& cntx) const {
+		auto maybeFile = MappedFile::open(cntx.retain(path));
+		if (!maybeFile) {
+			return maybeFile.moveError();
+		}
+
+		if constexpr (std::is_same_v<Dest, MappedFile>) {
+			*dest = Solace::mv(maybeFile.unwrap());
+		} else {
+			dest->emplace_back(Solace::mv(maybeFile.unwrap()));
+		}
+
+		return Solace::none;
+	}
+
+	Solace::Optional<Error>
+	operator() (Solace::Optional<Solace::StringView> const& path, Parser::Context const& cntx) const {
+		return (*this)(path.get(), cntx);
+	}
+
+	Dest* dest;
+};
+
+
+template<typename Dest>
+MapFileInto<Dest> mapFileInto(Dest* dest) noexcept {
+	return {dest};
+}
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_MAPPEDFILE_HPP
@@ -0,0 +1,160 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/pathValidator.hpp
+ *	@brief		Parallel validation of large lists of path arguments.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_PATHVALIDATOR_HPP
+#define CLIME_EXTRAS_PATHVALIDATOR_HPP
+
+#include "clime/parser.hpp"
+
+#include <unistd.h>  // R_OK
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace clime::extras {
+
+/**
+ * Result of validation of a single path.
+ */
+struct PathStatus {
+	using size_type = Parser::Context::size_type;
+
+	/// Position of the path in argv.
+	size_type			position;
+
+	/// Path as given on the command line.
+	Solace::StringView	path;
+
+	/// errno value of the failed check, zero if the path is accessible.
+	int					errorCode{0};
+
+	bool isOk() const noexcept { return errorCode == 0; }
+};
+
+
+/**
+ * Validator checking that paths given as trailing arguments are accessible.
+ *
+ * On a network file system checking paths one by one can take longer than parsing everything else.
+ * The validator collects paths while arguments are parsed and, once the whole command line is parsed,
+ * checks them with access(2) in batches processed by a bounded number of threads of ThreadPool::shared().
+ * Results of all the paths, in argv order, are given to a single report callback,
+ * which decides if the parse fails. The collector may be used by an independent argument.
+ *
+ * Validation runs as a deferred task, @see Parser::DeferredTask, so it overlaps with other deferred loads.
+ * Replays of cached parses and parse snapshots run deferred tasks too.
+ * Each parse registers its own task and starts collecting paths afresh, so a validator can be reused.
+ * Only if the collector is called with a context that has no list of deferred tasks,
+ * each path is checked and reported on its own as soon as it is parsed.
+ *
+ * \code{.cpp}
+ auto validator = PathValidator{[](ArrayView<PathStatus const> results) -> Optional<Error> {
+		auto const nbFailed = std::count_if(results.begin(), results.end(), [](auto& r) { return !r.isOk(); });
+		...
+	}};
+
+ parser.arguments({
+	{"*", "Files to process", validator.collector()}
+ });
+ \endcode
+ */
+class PathValidator {
+public:
+	using size_type = PathStatus::size_type;
+	using Report = std::function<Solace::Optional<Error>(Solace::ArrayView<PathStatus const>)>;
+
+	/// Default number of paths checked by a worker at a time.
+	static constexpr size_type kDefaultBatchSize = 64;
+
+	PathValidator(PathValidator const&) = delete;
+	PathValidator& operator= (PathValidator const&) = delete;
+
+	/**
+	 * Construct a validator.
+	 * @param report Callback to be given results of all the paths. Returned error fails the parse.
+	 * @param concurrencyLimit Maximum number of threads checking paths.
+	 * Zero means the limit of the parser, @see Parser::concurrencyLimit().
+	 * @param accessMode Access mode to check, @see access(2).
+	 * @param batchSize Number of paths checked by a worker at a time.
+	 */
+	explicit PathValidator(Report report,
+						   size_type concurrencyLimit = 0,
+						   int accessMode = R_OK,
+						   size_type batchSize = kDefaultBatchSize)
+		: _report{Solace::mv(report)}
+		, _concurrencyLimit{concurrencyLimit}
+		, _accessMode{accessMode}
+		, _batchSize{batchSize > 0 ? batchSize : kDefaultBatchSize}
+	{}
+
+	/**
+	 * Get an argument callback collecting paths for validation.
+	 * The validator must outlive parsers using the callback.
+	 */
+	auto collector() {
+		return [this](Solace::StringView path, Parser::Context const& cntx) { return collect(path, cntx); };
+	}
+
+	/**
+	 * Check all the paths collected so far.
+	 * @param cancellation Token to stop validation. Unchecked paths are reported with ECANCELED.
+	 * @return Results for all the paths in the order they have been given.
+	 */
+	std::vector<PathStatus> validate(CancellationToken const& cancellation = {}) const;
+
+	/// Paths collected so far.
+	std::vector<PathStatus> const& paths() const noexcept { return _paths; }
+
+	/// Forget collected paths. Paths are also forgotten once another parse collects a path.
+	void reset() noexcept { _paths.clear(); }
+
+private:
+
+	/// Deferred task validating paths collected by a parse.
+	struct ValidateTask {
+		Solace::Result<void, Error> operator() (CancellationToken const& cancellation) const;
+
+		PathValidator* validator;
+	};
+
+	Solace::Optional<Error> collect(Solace::StringView path, Parser::Context const& cntx);
+
+	/// Check if the validation task has been registered into the deferred tasks of a parse.
+	bool isRegistered(std::vector<Parser::DeferredTask> const& tasks) const noexcept;
+
+private:
+	Report						_report;
+	size_type					_concurrencyLimit;
+	int							_accessMode;
+	size_type					_batchSize;
+
+	/// Guards collected paths against concurrent calls of the collector.
+	std::mutex					_lock;
+	std::vector<PathStatus>		_paths;
+
+	/// Concurrency limit of the parser that has collected the paths.
+	size_type					_parserConcurrencyLimit{0};
+};
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_PATHVALIDATOR_HPP
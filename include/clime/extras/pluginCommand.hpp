@@ -0,0 +1,99 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/pluginCommand.hpp
+ *	@brief		Sub-commands implemented by shared objects loaded when selected.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_PLUGINCOMMAND_HPP
+#define CLIME_EXTRAS_PLUGINCOMMAND_HPP
+
+#include "clime/parser.hpp"
+
+#include <vector>
+
+
+namespace clime::extras {
+
+/**
+ * Name of the function a plugin exports to build its command:
+ * \code{.cpp}
+ extern "C" int clime_plugin_command(clime::Parser::Command* command) {
+	command->action(...)
+		.options(...);
+
+	return 0;
+ }
+ \endcode
+ * The command is given with the description from the manifest. Non zero result is a load error.
+ * A plugin must be built against the same version of libclime as the application loading it.
+ */
+constexpr char const kPluginEntryPoint[] = "clime_plugin_command";
+
+/// Type of the function a plugin exports, @see kPluginEntryPoint.
+using PluginEntryPoint = int (*)(Parser::Command* command);
+
+
+/**
+ * Entry of a plugin manifest: a sub-command implemented by a shared object.
+ * Views refer to the text of the manifest, which must outlive commands built from it.
+ */
+struct PluginEntry {
+	/// Name of the sub-command.
+	Solace::StringView	name;
+
+	/// Path of the shared object, as accepted by dlopen(3).
+	Solace::StringView	path;
+
+	/// Description shown in help without loading the shared object.
+	Solace::StringView	description;
+};
+
+
+/**
+ * Parse a plugin manifest.
+ * Each line of a manifest is either blank, a comment starting with '#',
+ * or a plugin entry: name and path of the shared object, followed by description:
+ * \code
+ # name		path					description
+ deploy		/usr/lib/tool/deploy.so	Deploy a release
+ \endcode
+ * @param manifest Text of the manifest, @see MappedFile to load it.
+ * @return Plugin entries in the order given, or an error tagged with the first malformed line.
+ */
+Solace::Result<std::vector<PluginEntry>, Error>
+parsePluginManifest(Solace::StringView manifest);
+
+
+/**
+ * Build a lazy command implemented by a plugin.
+ * The shared object is loaded only once the command is selected by a command line, or help for it is requested.
+ * Loaded objects are never unloaded, as actions of their commands may be called at any time.
+ * Failure to load a plugin is a parse error tagged with the path of the shared object.
+ *
+ * \code{.cpp}
+ auto manifest = MappedFile::open("/etc/tool/plugins");
+ ...
+ for (auto const& entry : parsePluginManifest(manifest.unwrap().view()).unwrap()) {
+	parser.addCommand(entry.name, pluginCommand(entry));
+ }
+ \endcode
+ */
+Parser::Command pluginCommand(PluginEntry const& entry);
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_PLUGINCOMMAND_HPP
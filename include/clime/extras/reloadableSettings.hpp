@@ -0,0 +1,179 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/reloadableSettings.hpp
+ *	@brief		Settings object that can be re-parsed and published while application is running.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_RELOADABLESETTINGS_HPP
+#define CLIME_EXTRAS_RELOADABLESETTINGS_HPP
+
+#include "clime/parser.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+
+namespace clime::extras {
+
+/**
+ * Settings of type T that can be updated by re-parsing command line while the application is running.
+ *
+ * Parser options are bound to the staging instance of the settings. Each (re)load resets staging instance to
+ * the currently published snapshot, re-runs the parser, validates the result and publishes a new immutable snapshot.
+ * Only options marked as reloadable are applied by a reload, @see Parser::Option::reloadable().
+ *
+ * Readers access current snapshot without locking: publishing is a single atomic pointer swap.
+ * Snapshots replaced by a reload are retired rather than destroyed, as readers may still be using them.
+ * It is up to the application to call reclaim() once no reader holds a reference obtained before the last reload,
+ * for example at the end of each request processing loop iteration.
+ *
+ * Triggering a reload (on SIGHUP, inotify event for the config file, etc) is left to the application event loop:
+ * \code{.cpp}
+ Settings defaults{};
+ ReloadableSettings<Settings> settings{defaults};
+ auto parser = Parser{"My server", {
+		Parser::Option{{"cache"}, "Cache size", &settings.staging()->cacheSize}.reloadable(),
+		{{"port"}, "Port to listen on", &settings.staging()->port}
+ }};
+
+ settings.load(parser, args);
+ ...
+ // On SIGHUP:
+ settings.reload(parser, args, [](Settings const& s) -> Optional<Error> { ... });
+ ...
+ // Hot-path
+ auto const& config = settings.current();
+ \endcode
+ */
+template<typename T>
+class ReloadableSettings {
+public:
+	using Validator = std::function<Solace::Optional<Error> (T const&)>;
+
+	~ReloadableSettings() {
+		delete _current.load(std::memory_order_acquire);
+	}
+
+	ReloadableSettings(ReloadableSettings const&) = delete;
+	ReloadableSettings& operator= (ReloadableSettings const&) = delete;
+
+	explicit ReloadableSettings(T initial = T{})
+		: _staging{initial}
+		, _current{new T{Solace::mv(initial)}}
+	{}
+
+	/**
+	 * Get an instance to bind parser options to.
+	 * Staging instance is only modified by load/reload and must not be accessed by readers.
+	 */
+	T* staging() noexcept { return &_staging; }
+
+	/**
+	 * Get currently published snapshot of the settings.
+	 * The reference is valid until reclaim() is called after the next reload.
+	 */
+	T const& current() const noexcept {
+		return *_current.load(std::memory_order_acquire);
+	}
+
+	/// Number of snapshots published since construction.
+	Solace::uint64 generation() const noexcept {
+		return _generation.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Parse initial configuration applying all the options.
+	 * @param parser Parser with options bound to the staging instance.
+	 * @param args Command line arguments.
+	 * @param validate Optional validator to check new settings before they are published.
+	 * @return Error if parsing or validation failed, in which case the current snapshot remains unchanged.
+	 */
+	Solace::Result<void, Error>
+	load(Parser const& parser, Solace::ArrayView<const char*> args, Validator const& validate = {}) {
+		return update(parser, args, validate, Parser::Pass::Startup);
+	}
+
+	/**
+	 * Re-parse configuration applying only reloadable options.
+	 * @param parser Parser with options bound to the staging instance.
+	 * @param args Command line arguments.
+	 * @param validate Optional validator to check new settings before they are published.
+	 * @return Error if parsing or validation failed, in which case the current snapshot remains unchanged.
+	 */
+	Solace::Result<void, Error>
+	reload(Parser const& parser, Solace::ArrayView<const char*> args, Validator const& validate = {}) {
+		return update(parser, args, validate, Parser::Pass::Reload);
+	}
+
+	/**
+	 * Destroy snapshots retired by previous reloads.
+	 * Must only be called when no reader holds a reference to a snapshot other then the current one.
+	 */
+	void reclaim() {
+		std::lock_guard<std::mutex> lock{_writerLock};
+		_retired.clear();
+	}
+
+private:
+
+	Solace::Result<void, Error>
+	update(Parser const& parser, Solace::ArrayView<const char*> args, Validator const& validate, Parser::Pass pass) {
+		std::lock_guard<std::mutex> lock{_writerLock};
+
+		// Start from the published state so that a failed attempt leaves no trace
+		_staging = *_current.load(std::memory_order_acquire);
+
+		auto parseResult = parser.parse(args, pass);
+		if (!parseResult) {
+			return parseResult.moveError();
+		}
+
+		if (validate) {
+			auto maybeError = validate(_staging);
+			if (maybeError) {
+				return maybeError.move();
+			}
+		}
+
+		auto next = std::make_unique<T const>(_staging);
+		_retired.emplace_back(_current.exchange(next.release(), std::memory_order_acq_rel));
+		_generation.fetch_add(1, std::memory_order_acq_rel);
+
+		return Solace::Ok();
+	}
+
+private:
+	/// Writers are serialized, readers never take the lock.
+	std::mutex							_writerLock;
+
+	/// Instance parser options are bound to.
+	T									_staging;
+
+	/// Currently published snapshot.
+	std::atomic<T const*>				_current;
+
+	/// Snapshots replaced by reloads waiting to be reclaimed.
+	std::vector<std::unique_ptr<T const>>	_retired;
+
+	std::atomic<Solace::uint64>			_generation{0};
+};
+
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_RELOADABLESETTINGS_HPP
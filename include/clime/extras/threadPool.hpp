@@ -0,0 +1,34 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/extras/threadPool.hpp
+ *	@brief		Fixed size pool of worker threads, moved to the core library.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_EXTRAS_THREADPOOL_HPP
+#define CLIME_EXTRAS_THREADPOOL_HPP
+
+#include "clime/threadPool.hpp"
+
+
+namespace clime::extras {
+
+/// @see clime::ThreadPool
+using ThreadPool = clime::ThreadPool;
+
+}  // End of namespace clime::extras
+#endif  // CLIME_EXTRAS_THREADPOOL_HPP
@@ -0,0 +1,292 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/parseCache.hpp
+ *	@brief		Memoization of parse results for repeated identical command lines.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_PARSECACHE_HPP
+#define CLIME_PARSECACHE_HPP
+
+#include "parser.hpp"
+
+#include <list>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+
+namespace clime {
+
+/**
+ * Trace of a parse: a compact record of the values applied to bindings and of the resolved command.
+ *
+ * Options and arguments bound to a variable record the converted value, so replay is a plain copy.
+ * Custom callbacks record location of the value in argv and are called again on replay.
+ * A trace becomes non-replayable if an option that is not cacheable has been applied, @see Option::cacheable().
+ */
+class ParseTrace {
+public:
+	using size_type = Solace::uint32;
+
+	/// Location of a value as a substring of an argv token.
+	struct Location {
+		size_type	token;
+		size_type	offset;
+		size_type	length;
+	};
+
+	/// Token index of a location that refers to no value.
+	static constexpr size_type kNoToken = ~size_type{0};
+
+	/// A single recorded effect of the parse.
+	struct Step {
+		enum class Kind : Solace::uint8 {
+			Store,			//!< Copy converted value bits into a bound variable.
+			StoreView,		//!< Bind a StringView variable to a substring of argv.
+			OptionCall,		//!< Call an option callback.
+			ArgumentCall,	//!< Call an argument callback.
+			OptionMark,		//!< Option applied by the preceding steps. Not replayed.
+			ArgumentMark,	//!< Argument applied by the preceding steps. Not replayed.
+			CommandMark		//!< Sub-command selected by name. Not replayed.
+		};
+
+		Kind		kind;
+
+		/// Number of bytes of the value to store.
+		Solace::uint8	size;
+
+		/// Offset of the token being parsed, as given to the callback in the context.
+		size_type	contextOffset;
+
+		/// Location of the value in argv.
+		Location	value;
+
+		/// Location of the option name in argv.
+		Location	name;
+
+		union {
+			void*						dest;
+			Parser::Option const*		option;
+			Parser::Argument const*		argument;
+		};
+
+		/// Converted value for Store steps.
+		Solace::uint64	bits;
+	};
+
+public:
+
+	/// Record a converted value stored into a bound variable.
+	template<typename T>
+	void store(T* dest, T const& value) noexcept {
+		static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(Step::bits),
+					  "Only small trivially copyable values can be stored in a trace");
+
+		storeBytes(dest, &value, sizeof(T));
+	}
+
+	/// Record bytes of a converted value stored into a bound variable. Size must not exceed sizeof(Step::bits).
+	void storeBytes(void* dest, void const* value, size_t size) noexcept;
+
+	/// Record a StringView variable bound to a value from argv.
+	void storeView(Solace::StringView* dest, Solace::StringView value, Parser::Context const& cntx);
+
+	/**
+	 * Record an option having been applied.
+	 * @param option The option matched.
+	 * @param mark Size of the trace before the option callback has been called.
+	 * @param value Value given to the option.
+	 * @param cntx Context given to the option callback.
+	 */
+	void optionApplied(Parser::Option const& option, size_type mark,
+					   Solace::Optional<Solace::StringView> const& value, Parser::Context const& cntx);
+
+	/**
+	 * Record an argument having been applied.
+	 * @param argument The argument matched.
+	 * @param mark Size of the trace before the argument callback has been called.
+	 * @param value Value given to the argument.
+	 * @param cntx Context given to the argument callback.
+	 */
+	void argumentApplied(Parser::Argument const& argument, size_type mark,
+						 Solace::StringView value, Parser::Context const& cntx);
+
+	/**
+	 * Record a sub-command having been selected.
+	 * @param name Location of the name of the sub-command in argv.
+	 */
+	void commandSelected(Location name);
+
+	/// Record the command selected by the parse.
+	void resolved(Parser::Command const& command) noexcept { _command = &command; }
+
+	/// Mark the trace as not replayable.
+	void invalidate() noexcept { _replayable = false; }
+
+	/// Check if the parse can be reproduced by replaying this trace.
+	bool isReplayable() const noexcept { return _replayable && _command; }
+
+	/// Number of recorded steps.
+	size_type size() const noexcept { return static_cast<size_type>(_steps.size()); }
+
+	std::vector<Step> const& steps() const noexcept { return _steps; }
+
+	/// Command selected by the recorded parse.
+	Parser::Command const* command() const noexcept { return _command; }
+
+	/// Number of bytes used by the trace.
+	size_t memoryUsed() const noexcept { return sizeof(*this) + _steps.capacity() * sizeof(Step); }
+
+	/// Forget all the recorded steps.
+	void clear() noexcept;
+
+	/**
+	 * Apply recorded values to the bindings.
+	 * @param cntx Context of the parse to replay into. Its argv must be identical to the one recorded.
+	 * @return Action of the recorded command or an error returned by a callback.
+	 */
+	Solace::Result<Parser::ParseResult, Error> replay(Parser::Context const& cntx) const;
+
+private:
+
+	/// Find location of a value in argv tokens starting at the context offset.
+	bool locate(Solace::StringView value, Parser::Context const& cntx, Location& location) const noexcept;
+
+private:
+	std::vector<Step>			_steps;
+	Parser::Command const*		_command{nullptr};
+	bool						_replayable{true};
+};
+
+
+/**
+ * Cache of parse results keyed by the argv tokens.
+ *
+ * A daemon dispatching command lines typically sees the same few command lines over and over again.
+ * On a hit, the cache replays recorded trace of the previous parse instead of matching options and converting values.
+ * Parse errors and command lines with non-cacheable options are never cached.
+ *
+ * Entries are evicted in least-recently-used order when either number of entries or memory used exceeds the limits.
+ * The parser must not be modified while it is used by a cache.
+ * Cache is not thread-safe, concurrent parses must be serialized by the user.
+ */
+class ParseCache {
+public:
+	using size_type = Solace::uint32;
+
+	/// Default maximum number of cached command lines.
+	static constexpr size_type kDefaultMaxEntries = 256;
+
+	/// Default maximum number of bytes used by cached command lines.
+	static constexpr size_t kDefaultMaxMemory = 256 * 1024;
+
+	/// Cache effectiveness counters.
+	struct Stats {
+		Solace::uint64	hits{0};
+		Solace::uint64	misses{0};
+		Solace::uint64	evictions{0};
+
+		/// Number of parses that could not be cached.
+		Solace::uint64	uncacheable{0};
+
+		size_type		entries{0};
+		size_t			memoryUsed{0};
+
+		/// Ratio of hits to all lookups.
+		Solace::float64 hitRate() const noexcept {
+			auto const lookups = hits + misses;
+			return (lookups > 0) ? static_cast<Solace::float64>(hits) / static_cast<Solace::float64>(lookups) : 0;
+		}
+	};
+
+public:
+
+	ParseCache(ParseCache const&) = delete;
+	ParseCache& operator= (ParseCache const&) = delete;
+
+	/**
+	 * Construct a cache.
+	 * @param parser Parser to use on a miss. Must outlive the cache.
+	 * @param maxEntries Maximum number of command lines to keep.
+	 * @param maxMemory Maximum number of bytes to be used by cached command lines.
+	 */
+	explicit ParseCache(Parser const& parser,
+						size_type maxEntries = kDefaultMaxEntries,
+						size_t maxMemory = kDefaultMaxMemory) noexcept
+		: _parser{parser}
+		, _maxEntries{maxEntries}
+		, _maxMemory{maxMemory}
+	{}
+
+	/**
+	 * Parse command line arguments, replaying a cached result if the same command line has been parsed before.
+	 * @see Parser::parse()
+	 */
+	Solace::Result<Parser::ParseResult, Error>
+	parse(Solace::ArrayView<const char*> args, Parser::Pass pass = Parser::Pass::Startup);
+
+	/**
+	 * Parse command line arguments given in a transient buffer.
+	 * @see Parser::parse(args, arena, pass)
+	 */
+	Solace::Result<Parser::ParseResult, Error>
+	parse(Solace::ArrayView<const char*> args, StringArena& arena, Parser::Pass pass = Parser::Pass::Startup);
+
+	Stats const& stats() const noexcept { return _stats; }
+
+	/// Drop all the cached entries. Counters are preserved.
+	void clear() noexcept;
+
+private:
+
+	struct Entry {
+		Solace::uint64		hash;
+		Parser::Pass		pass;
+
+		/// NUL-delimited argv tokens.
+		std::string			key;
+		ParseTrace			trace;
+
+		size_t memoryUsed() const noexcept { return sizeof(*this) + key.capacity() + trace.memoryUsed(); }
+	};
+
+	using EntryList = std::list<Entry>;
+
+	Solace::Result<Parser::ParseResult, Error>
+	parse(Solace::ArrayView<const char*> args, Parser::Pass pass, StringArena* arena);
+
+	/// Store a successfully recorded parse, evicting least recently used entries to fit the limits.
+	void insert(Entry&& entry);
+
+	void evictLast() noexcept;
+
+private:
+	Parser const&		_parser;
+	size_type			_maxEntries;
+	size_t				_maxMemory;
+
+	/// Entries in most-recently-used order.
+	EntryList			_entries;
+	std::unordered_map<Solace::uint64, EntryList::iterator>		_index;
+
+	Stats				_stats;
+};
+
+}  // End of namespace clime
+#endif  // CLIME_PARSECACHE_HPP
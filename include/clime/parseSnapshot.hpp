@@ -0,0 +1,106 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/parseSnapshot.hpp
+ *	@brief		Binary snapshot of a completed parse to be rebound by other processes.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_PARSESNAPSHOT_HPP
+#define CLIME_PARSESNAPSHOT_HPP
+
+#include "parseCache.hpp"
+
+#include <string>
+
+
+namespace clime {
+
+/**
+ * Versioned binary snapshot of a completed parse, to hand parsed configuration over to child processes.
+ *
+ * A snapshot holds the argv tokens, the path of selected sub-commands and, for each option and argument applied,
+ * its position in the command tree and locations of its name and value in argv.
+ * Rebinding a snapshot calls callbacks of the recorded options and arguments with the recorded values,
+ * without matching options or selecting commands. No pointers are stored,
+ * so a snapshot can be rebound by a re-executed binary, which memory layout differs.
+ *
+ * A snapshot carries a fingerprint of the schema of the commands on its path: names of options and arguments,
+ * value expectations and choices. Rebinding is rejected if the schema of the parser differs.
+ * Integers are stored in the native byte order: snapshots are meant to be passed between processes on the same host.
+ *
+ * \code{.cpp}
+ ParseTrace trace;
+ auto action = parser.parse(args, trace, nullptr);
+ auto snapshot = ParseSnapshot::capture(parser, args, trace);
+ // Write snapshot.unwrap().view() into a memfd and pass it to workers.
+ ...
+ // In a worker, given the mapped snapshot:
+ auto action = ParseSnapshot::rebind(parser, mappedSnapshot.view());
+ \endcode
+ */
+class ParseSnapshot {
+public:
+	using size_type = ParseTrace::size_type;
+
+	/// First bytes of a snapshot: "CLPS".
+	static constexpr Solace::uint32 kMagic = 0x53504C43;
+
+	/// Version of the snapshot format.
+	static constexpr Solace::uint16 kVersion = 1;
+
+	/**
+	 * Capture a snapshot of a parse.
+	 * @param parser Parser that has been used to parse the command line.
+	 * @param args Command line arguments that have been parsed.
+	 * @param trace Trace recorded by the parse, @see Parser::parse(args, trace, arena).
+	 * @return Snapshot or an error if the trace is not replayable.
+	 */
+	static Solace::Result<ParseSnapshot, Error>
+	capture(Parser const& parser, Solace::ArrayView<const char*> args, ParseTrace const& trace);
+
+	/**
+	 * Apply values recorded in a snapshot.
+	 * Values bound to a StringView refer to the snapshot, unless an arena is given to copy them into.
+	 * @param parser Parser with the same schema as the one that has captured the snapshot.
+	 * @param snapshot Bytes of a snapshot.
+	 * @param arena Arena to copy string values into if the snapshot is not kept.
+	 * @return Action of the recorded command, or an error if the snapshot is malformed or the schema differs.
+	 */
+	static Solace::Result<Parser::ParseResult, Error>
+	rebind(Parser const& parser, Solace::StringView snapshot, StringArena* arena = nullptr);
+
+	/**
+	 * Compute a fingerprint of the schema of a path of commands.
+	 * @param path Commands from the top level one to the selected one.
+	 * @return 64 bit hash of names and value expectations of the options and arguments of the commands.
+	 */
+	static Solace::uint64 fingerprint(Solace::ArrayView<Parser::Command const*> path) noexcept;
+
+	/// Bytes of the snapshot.
+	Solace::StringView view() const noexcept {
+		return {_data.data(), static_cast<Solace::StringView::size_type>(_data.size())};
+	}
+
+	/// Size of the snapshot in bytes.
+	size_type size() const noexcept { return static_cast<size_type>(_data.size()); }
+
+private:
+	std::string		_data;
+};
+
+}  // End of namespace clime
+#endif  // CLIME_PARSESNAPSHOT_HPP
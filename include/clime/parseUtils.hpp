@@ -22,14 +22,31 @@
 #ifndef CLIME_PARSEUTILS_HPP
 #define CLIME_PARSEUTILS_HPP
 
+#include "errorCategory.hpp"
+
 #include <solace/types.hpp>
 #include <solace/string.hpp>
 #include <solace/result.hpp>
 #include <solace/error.hpp>
 
+#include <chrono>
+#include <type_traits>
+
 
 namespace clime {
 
+/// Number of bytes, such as a size of a cache or a buffer.
+struct ByteSize {
+	Solace::uint64	bytes;
+};
+
+inline bool operator== (ByteSize lhs, ByteSize rhs) noexcept { return lhs.bytes == rhs.bytes; }
+inline bool operator!= (ByteSize lhs, ByteSize rhs) noexcept { return lhs.bytes != rhs.bytes; }
+
+/// Point in time in UTC with nanosecond resolution.
+using UtcTimestamp = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
+
 Solace::Result<bool, Solace::Error> tryParseBoolean(Solace::StringView value) noexcept;
 
 Solace::Result<Solace::int8, Solace::Error> tryParseInt8(Solace::StringView value) noexcept;
@@ -48,9 +65,53 @@ Solace::Result<Solace::uint32, Solace::Error> tryParseUInt32(Solace::StringView
 
 Solace::Result<Solace::uint64, Solace::Error> tryParseUInt64(Solace::StringView value) noexcept;
 
+Solace::Result<Solace::float32, Solace::Error> tryParseFloat32(Solace::StringView value) noexcept;
+
+Solace::Result<Solace::float64, Solace::Error> tryParseFloat64(Solace::StringView value) noexcept;
+
+/**
+ * Parse a duration given as a sequence of numbers with units, such as `250ms`, `1.5s` or `1h30m`.
+ * Units are: ns, us, ms, s, m, h and d. A number may have a fractional part as long as the result is
+ * a whole number of nanoseconds. Zero may be given without a unit.
+ */
+Solace::Result<std::chrono::nanoseconds, Solace::Error> tryParseDuration(Solace::StringView value) noexcept;
+
+/**
+ * Parse a number of bytes with an optional unit suffix, such as `4096`, `64GiB` or `1.5MB`.
+ * SI suffixes kB, MB, GB, TB, PB and EB are powers of 1000. IEC suffixes KiB, MiB, GiB, TiB, PiB and EiB
+ * as well as single letter suffixes K, M, G, T, P and E are powers of 1024.
+ */
+Solace::Result<ByteSize, Solace::Error> tryParseByteSize(Solace::StringView value) noexcept;
+
+/**
+ * Parse an RFC 3339 timestamp, such as `2026-10-01T00:00:00Z` or `2026-10-01 12:30:00.250+02:00`.
+ * A date without time denotes the midnight UTC.
+ */
+Solace::Result<UtcTimestamp, Solace::Error> tryParseTimestamp(Solace::StringView value) noexcept;
+
+/// Parse a duration into a coarser duration type. It is an error if the value is not a whole number of units.
+template<typename D>
+Solace::Result<D, Solace::Error> tryParseDurationAs(Solace::StringView value) noexcept {
+	auto maybeDuration = tryParseDuration(value);
+	if (!maybeDuration) {
+		return maybeDuration.moveError();
+	}
+
+	auto const duration = std::chrono::duration_cast<D>(maybeDuration.unwrap());
+	if (duration != maybeDuration.unwrap()) {
+		return makeParserError(ParserError::OptionParsing, "Duration is not a whole number of units");
+	}
+
+	return Solace::Ok(duration);
+}
+
 
+/// Parse a value of type T. Only the types specialized below are supported, @see ValueParser for other types.
 template<typename T>
-Solace::Result<T, Solace::Error> tryParse(Solace::StringView value) noexcept;
+Solace::Result<T, Solace::Error> tryParse(Solace::StringView) noexcept {
+	static_assert(sizeof(T) == 0,
+				  "tryParse<T> is not defined for this type: specialize clime::ValueParser<T> to bind options to it");
+}
 
 
 template<>
@@ -98,6 +159,113 @@ inline
 Solace::Result<Solace::uint64, Solace::Error>
 tryParse<Solace::uint64>(Solace::StringView value) noexcept { return tryParseUInt64(value); }
 
+template<>
+inline
+Solace::Result<Solace::float32, Solace::Error>
+tryParse<Solace::float32>(Solace::StringView value) noexcept { return tryParseFloat32(value); }
+
+template<>
+inline
+Solace::Result<Solace::float64, Solace::Error>
+tryParse<Solace::float64>(Solace::StringView value) noexcept { return tryParseFloat64(value); }
+
+
+template<>
+inline
+Solace::Result<std::chrono::nanoseconds, Solace::Error>
+tryParse<std::chrono::nanoseconds>(Solace::StringView value) noexcept { return tryParseDuration(value); }
+
+template<>
+inline
+Solace::Result<std::chrono::microseconds, Solace::Error>
+tryParse<std::chrono::microseconds>(Solace::StringView value) noexcept {
+	return tryParseDurationAs<std::chrono::microseconds>(value);
+}
+
+template<>
+inline
+Solace::Result<std::chrono::milliseconds, Solace::Error>
+tryParse<std::chrono::milliseconds>(Solace::StringView value) noexcept {
+	return tryParseDurationAs<std::chrono::milliseconds>(value);
+}
+
+template<>
+inline
+Solace::Result<std::chrono::seconds, Solace::Error>
+tryParse<std::chrono::seconds>(Solace::StringView value) noexcept {
+	return tryParseDurationAs<std::chrono::seconds>(value);
+}
+
+template<>
+inline
+Solace::Result<ByteSize, Solace::Error>
+tryParse<ByteSize>(Solace::StringView value) noexcept { return tryParseByteSize(value); }
+
+template<>
+inline
+Solace::Result<UtcTimestamp, Solace::Error>
+tryParse<UtcTimestamp>(Solace::StringView value) noexcept { return tryParseTimestamp(value); }
+
+
+
+/**
+ * Conversion of a string value of an option or an argument into a value of type T.
+ * This is a customization point: specialize it for a user type to bind options and arguments
+ * directly to variables of that type. The default implementation uses tryParse<T>.
+ *
+ * A specialization must provide:
+ * \code
+ *   static Solace::Result<T, Solace::Error> parse(Solace::StringView value);
+ * \endcode
+ */
+template<typename T>
+struct ValueParser {
+	static Solace::Result<T, Solace::Error> parse(Solace::StringView value) noexcept { return tryParse<T>(value); }
+};
+
+
+template<>
+struct ValueParser<Solace::StringView> {
+	static Solace::Result<Solace::StringView, Solace::Error> parse(Solace::StringView value) noexcept {
+		return Solace::Ok(value);
+	}
+};
+
+
+namespace detail {
+
+template<typename T>
+struct IsDuration : std::false_type {};
+
+template<typename Rep, typename Period>
+struct IsDuration<std::chrono::duration<Rep, Period>> : std::true_type {};
+
+}  // namespace detail
+
+
+/// Kind of values of type T, reported with errors of conversion of a value into T.
+template<typename T>
+constexpr ValueKind valueKindOf() noexcept {
+	if constexpr (std::is_same_v<T, bool>) {
+		return ValueKind::Flag;
+	} else if constexpr (std::is_enum_v<T>) {
+		return ValueKind::Choice;
+	} else if constexpr (std::is_integral_v<T>) {
+		return std::is_signed_v<T> ? ValueKind::Integer : ValueKind::Unsigned;
+	} else if constexpr (std::is_floating_point_v<T>) {
+		return ValueKind::Float;
+	} else if constexpr (std::is_same_v<T, Solace::StringView>) {
+		return ValueKind::String;
+	} else if constexpr (std::is_same_v<T, ByteSize>) {
+		return ValueKind::ByteSize;
+	} else if constexpr (std::is_same_v<T, UtcTimestamp>) {
+		return ValueKind::Timestamp;
+	} else if constexpr (detail::IsDuration<T>::value) {
+		return ValueKind::Duration;
+	} else {
+		return ValueKind::Unknown;
+	}
+}
 
 }  // End of namespace clime
 #endif  // CLIME_PARSEUTILS_HPP
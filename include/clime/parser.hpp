@@ -22,7 +22,11 @@
 #ifndef CLIME_PARSER_HPP
 #define CLIME_PARSER_HPP
 
+#include "choices.hpp"
 #include "errorCategory.hpp"
+#include "executor.hpp"
+#include "parseUtils.hpp"
+#include "stringArena.hpp"
 
 #include <solace/stringView.hpp>
 #include <solace/result.hpp>
@@ -36,10 +40,17 @@
 #include <map>      // TODO(abbyssoul): Replace with fix-memory map
 #include <vector>   // TODO(abbyssoul): Replace with fix-memory vector
 #include <functional>   // TODO(abbyssoul): Replace with a better delegate, maybe?
+#include <memory>
+#include <string>
+#include <type_traits>
 
 
 namespace clime {
 
+class ParseTrace;
+class Diagnostics;
+
+
 /**
  * Command line parser
  * This is a helper class to handle processing of command line arguments.
@@ -82,12 +93,31 @@ namespace clime {
  */
 class Parser {
 public:
+
+	/**
+	 * Parsing pass.
+	 * Command line can be parsed more then once during the life of an application, for example to reload configuration.
+	 * Only options marked as reloadable are applied during a reload pass, @see Option::reloadable().
+	 */
+	enum class Pass {
+		Startup,		//!< Initial parsing: all the options are applied.
+		Reload			//!< Re-parsing of a running configuration: startup-only options are ignored.
+	};
+
+	/**
+	 * Deferred part of an option action, such as an expensive load, @see Option::deferred().
+	 * Deferred tasks given on a command line run concurrently once the whole command line has been parsed.
+	 */
+	using DeferredTask = std::function<Solace::Result<void, Error>(CancellationToken const&)>;
+
     /**
      * Parser context.
      * This object represents the current state of parsing.
      * It is designed to be used by a callback function to get access to the parameters and parser object itself.
      * It also can be used to communicate back to the parser if an interruption is required.
      */
+    class Command;
+
     struct Context {
 		using ArgVector = Solace::ArrayView<char const*>;
 		using size_type = ArgVector::size_type;
@@ -104,23 +134,119 @@ public:
         /// Reference to the instance of the parser that invokes the callback.
         Parser const& parser;
 
+		/// Current parsing pass.
+		Pass const pass;
+
+		/// Arena to copy values into if argv is a transient buffer. Null if argv outlives parsed values.
+		StringArena* const arena;
+
+		/// Trace to record applied values into, so that the parse can be replayed. Null if not recording.
+		ParseTrace* const trace;
+
+		/// Tasks to run once parsing is done. Null if deferred tasks are to be run immediately.
+		std::vector<DeferredTask>* const deferred;
+
+		/// Command being parsed. Null if unknown, in which case it is the top level command of the parser.
+		Command const* const command;
+
+		/// Diagnostics to report errors into and carry on parsing. Null if parsing stops at the first error.
+		Diagnostics* const diagnostics;
+
 		constexpr Context(ArgVector args,
 						  size_type inOffset,
 						  Solace::StringView inName,
-						  Parser const& self) noexcept
+						  Parser const& self,
+						  Pass inPass = Pass::Startup,
+						  StringArena* inArena = nullptr,
+						  ParseTrace* inTrace = nullptr,
+						  std::vector<DeferredTask>* inDeferred = nullptr,
+						  Command const* inCommand = nullptr,
+						  Diagnostics* inDiagnostics = nullptr) noexcept
 			: argv{Solace::mv(args)}
 			, offset{inOffset}
 			, name{inName}
 			, parser{self}
+			, pass{inPass}
+			, arena{inArena}
+			, trace{inTrace}
+			, deferred{inDeferred}
+			, command{inCommand}
+			, diagnostics{inDiagnostics}
 		{}
 
 		constexpr Context withOffsetAndName(size_type newOffset, Solace::StringView newName) const noexcept {
+			return withCommand(command, newOffset, newName);
+		}
+
+		/// Get a context to parse a sub-command.
+		constexpr Context withCommand(Command const* newCommand,
+									  size_type newOffset,
+									  Solace::StringView newName) const noexcept {
 			return {argv,
 					newOffset,
 					newName,
-					parser };
+					parser,
+					pass,
+					arena,
+					trace,
+					deferred,
+					newCommand,
+					diagnostics};
+		}
+
+		/// Command being parsed, or the top level command of the parser if unknown.
+		Command const& currentCommand() const noexcept;
+
+		/// Index of the argv token a value is a part of: either the current token or the next one.
+		size_type indexOf(Solace::StringView value) const noexcept;
+
+		/**
+		 * Get a version of the value that can be kept after the parsing is done.
+		 * @param value A string value from argv.
+		 * @return A copy owned by the arena if argv is transient, value itself otherwise.
+		 */
+		Solace::StringView retain(Solace::StringView value) const {
+			return arena ? arena->copy(value) : value;
+		}
+
+		/**
+		 * Convert a value with ValueParser<T> and store it into a bound variable.
+		 * @param dest Variable to store the converted value into.
+		 * @param value A string value from argv.
+		 * @return Error if the value can't be converted.
+		 */
+		template<typename T>
+		Solace::Optional<Error> parseInto(T* dest, Solace::StringView value) const {
+			auto maybeValue = ValueParser<T>::parse(value);
+			if (!maybeValue) {
+				return makeParserError(ParserError::OptionParsing, indexOf(value), value, valueKindOf<T>());
+			}
+
+			bind(dest, Solace::mv(maybeValue.unwrap()));
+			return Solace::none;
 		}
 
+		/// Store a converted value into a bound variable, recording it in the trace if one is attached.
+		template<typename T>
+		void bind(T* dest, T value) const {
+			*dest = Solace::mv(value);
+
+			// Other values are replayed by calling the callback again
+			if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(Solace::uint64)) {
+				if (trace) {
+					record(dest, dest, sizeof(T));
+				}
+			}
+		}
+
+		/// Bind a StringView variable to a value from argv, copying the value into the arena if argv is transient.
+		void bind(Solace::StringView* dest, Solace::StringView value) const;
+
+	private:
+
+		/// Record bytes of a value stored into a bound variable.
+		void record(void* dest, void const* value, size_t size) const noexcept;
+
     };
 
     /**
@@ -146,18 +272,46 @@ public:
 		using OptionCallback = std::function<
 			Solace::Optional<Error> (Solace::Optional<Solace::StringView> const&, Context const&)>;
 
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::StringView* val);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::int8* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::uint8* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::int16* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::uint16* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::int32* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::uint32* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::int64* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::uint64* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::float32* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, Solace::float64* value);
-        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, bool* value);
+
+        /**
+         * Construct an option that converts its value with ValueParser<T> and stores it into a variable.
+         * A boolean option is a flag: its value is optional and the variable is set to true if no value is given.
+         * @param names Names of the option.
+         * @param desc Human-readable description of the option.
+         * @param dest Variable to store the converted value into.
+         */
+        template<typename T>
+        Option(std::initializer_list<Solace::StringLiteral> names, Solace::StringLiteral desc, T* dest)
+			: Option{names, desc, std::is_same_v<T, bool> ? ArgumentValue::Optional : ArgumentValue::Required,
+				[dest](Solace::Optional<Solace::StringView> const& value, Context const& cntx)
+						-> Solace::Optional<Error> {
+					if constexpr (std::is_same_v<T, bool>) {
+						if (!value) {
+							cntx.bind(dest, true);
+							return Solace::none;
+						}
+					}
+
+					return cntx.parseInto(dest, value.get());
+				}}
+		{}
+
+        /**
+         * Construct an option that binds one of the named choices to an enum variable.
+         * Valid choices are listed by the help formatter and by Option::choices().
+         * An invalid value is reported as UnexpectedValue positioned at its argv token, expecting ValueKind::Choice.
+         * @param names Names of the option.
+         * @param desc Human-readable description of the option.
+         * @param value Variable to store the value of the choice selected.
+         * @param choices Table of choices, @see makeChoices(). The table is copied into the option.
+         */
+        template<typename E, size_t N>
+        Option(std::initializer_list<Solace::StringLiteral> names,
+               Solace::StringLiteral desc,
+               E* value,
+               ChoiceTable<E, N> const& choices)
+            : Option{names, desc, value, choices, joinChoices(choices.names())}
+        {}
 
         /// Common constructor:
         template<typename F>
@@ -171,16 +325,112 @@ public:
 			, _callback{Solace::fwd<F>(f)}
         {}
 
+        /**
+         * Construct an option which action is partly deferred.
+         * The callback is called when the option is parsed, to validate the value and to return a task
+         * doing the expensive part of the work. Tasks of all the deferred options run concurrently,
+         * on up to Parser::concurrencyLimit() threads of ThreadPool::shared(),
+         * after the whole command line has been parsed and are joined before the parse returns.
+         * If a task fails the other tasks are cancelled and the error of the first failed option is returned.
+         * An exception escaping a task is reported as an OptionParsing error.
+         * Deferred options are not cacheable.
+         * @param names Names of the option.
+         * @param description Human-readable description of the option.
+         * @param expectsArgument Argument processing policy.
+         * @param f Callback (Optional<StringView> const&, Context const&) -> Result<DeferredTask, Error>.
+         * @return A new option.
+         */
+        template<typename F>
+        static Option deferred(std::initializer_list<Solace::StringLiteral> names,
+                               Solace::StringLiteral description,
+                               ArgumentValue expectsArgument,
+                               F&& f) {
+			auto option = Option{names, description, expectsArgument,
+				[callback = Solace::fwd<F>(f)](Solace::Optional<Solace::StringView> const& value, Context const& cntx)
+						-> Solace::Optional<Error> {
+					auto maybeTask = callback(value, cntx);
+					if (!maybeTask) {
+						return maybeTask.moveError();
+					}
+
+					if (cntx.deferred) {
+						cntx.deferred->emplace_back(Solace::mv(maybeTask.unwrap()));
+						return Solace::none;
+					}
+
+					auto taskResult = maybeTask.unwrap()(CancellationToken{});
+					if (!taskResult) {
+						return taskResult.moveError();
+					}
+
+					return Solace::none;
+				}};
+
+			// Tasks are collected by the parse, they can't be replayed from a cache
+			option.cacheable(false);
+
+			return option;
+		}
+
         Option& swap(Option& rhs) noexcept {
             using std::swap;
             swap(_names, rhs._names);
             swap(_description, rhs._description);
             swap(_callback, rhs._callback);
             swap(_expectsArgument, rhs._expectsArgument);
+			swap(_reloadable, rhs._reloadable);
+			swap(_cacheable, rhs._cacheable);
+			swap(_preScanned, rhs._preScanned);
+			swap(_choices, rhs._choices);
 
             return (*this);
         }
 
+		/**
+		 * Mark this option as safe to be re-applied when configuration is reloaded.
+		 * By default options are startup-only and ignored by the Pass::Reload parsing pass.
+		 * @param value True if the option can be changed in a running application.
+		 * @return Reference to this for fluent interface.
+		 */
+		Option& reloadable(bool value = true) noexcept {
+			_reloadable = value;
+			return *this;
+		}
+
+		bool isReloadable() const noexcept { return _reloadable; }
+
+		/**
+		 * Mark this option as safe to be memoized by a ParseCache.
+		 * Options with side effects other then setting a value, such as printing help, must not be cached:
+		 * a command line that contains such an option is always parsed in full.
+		 * @param value True if the effect of the option can be replayed from a cache.
+		 * @return Reference to this for fluent interface.
+		 */
+		Option& cacheable(bool value = true) noexcept {
+			_cacheable = value;
+			return *this;
+		}
+
+		bool isCacheable() const noexcept { return _cacheable; }
+
+		/**
+		 * Mark this top-level option to be recognized by a pre-scan of the options of the start command,
+		 * before the command line is parsed. Meant for options that end the parse, such as help or version,
+		 * so that they are also recognized when a multi-call applet is the start command.
+		 * If the action of the option returns no error the command line is parsed as usual,
+		 * without calling the action again.
+		 * The pre-scan stops at the first positional token: options of sub-commands are never pre-scanned,
+		 * and neither are options an applet redefines.
+		 * @param value True if the option is to be pre-scanned.
+		 * @return Reference to this for fluent interface.
+		 */
+		Option& preScanned(bool value = true) noexcept {
+			_preScanned = value;
+			return *this;
+		}
+
+		bool isPreScanned() const noexcept { return _preScanned; }
+
         bool isMatch(Solace::StringView argName) const noexcept;
 
 		Solace::Optional<Error>
@@ -192,6 +442,40 @@ public:
 
 		ArgumentValue argumentExpectations() const noexcept     { return _expectsArgument; }
 
+		/// Valid values of a choice option separated by '|', empty for other options.
+		Solace::StringView choices() const noexcept {
+			return _choices
+					? Solace::StringView{_choices->data(), static_cast<Solace::StringView::size_type>(_choices->size())}
+					: Solace::StringView{};
+		}
+
+    private:
+
+		template<typename E, size_t N>
+		Option(std::initializer_list<Solace::StringLiteral> names,
+			   Solace::StringLiteral desc,
+			   E* dest,
+			   ChoiceTable<E, N> const& table,
+			   std::shared_ptr<std::string const> choices)
+			: Option{names, desc, ArgumentValue::Required,
+				[dest, table](Solace::Optional<Solace::StringView> const& value, Context const& cntx)
+						-> Solace::Optional<Error> {
+					auto const index = table.indexOf(value.get());
+					if (index == table.size()) {
+						return makeParserError(ParserError::UnexpectedValue, cntx.indexOf(value.get()), value.get(),
+											   ValueKind::Choice);
+					}
+
+					*dest = table.value(index);
+					return Solace::none;
+				}}
+		{
+			_choices = Solace::mv(choices);
+		}
+
+		/// Join names of choices into a list of alternatives shown in help.
+		static std::shared_ptr<std::string const> joinChoices(Solace::ArrayView<const Solace::StringLiteral> names);
+
     private:
         //!< Long name of the option, Maybe empty if not specified.
 		std::vector<Solace::StringLiteral>	_names;
@@ -204,6 +488,18 @@ public:
 
         //!< A callback to be called when this option is encountered in the input cmd line.
 		OptionCallback						_callback;
+
+		//!< Flag to indicate if the option is applied when configuration is reloaded.
+		bool								_reloadable{false};
+
+		//!< Flag to indicate if the effect of the option can be replayed from a parse cache.
+		bool								_cacheable{true};
+
+		//!< Flag to indicate if the option is recognized by the top-level pre-scan.
+		bool								_preScanned{false};
+
+		//!< Precomputed list of valid values of a choice option.
+		std::shared_ptr<std::string const>	_choices;
     };
 
 
@@ -212,20 +508,21 @@ public:
      * It is a parsing error if no mandatory arguments is provided.
      */
 	struct Argument {
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::StringView* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::int8* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::uint8* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::int16* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::uint16* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::int32* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::uint32* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::int64* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::uint64* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::float32* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, Solace::float64* value);
-        Argument(Solace::StringLiteral name, Solace::StringLiteral description, bool* value);
+        /**
+         * Construct an argument that converts its value with ValueParser<T> and stores it into a variable.
+         * @param name Name of the argument.
+         * @param description Human-readable description of the argument.
+         * @param dest Variable to store the converted value into.
+         */
+        template<typename T>
+        Argument(Solace::StringLiteral name, Solace::StringLiteral description, T* dest)
+			: Argument{name, description, [dest](Solace::StringView value, Context const& cntx) {
+					return cntx.parseInto(dest, value);
+				}}
+		{}
 
-        template<typename F>
+        template<typename F,
+				 typename = std::enable_if_t<std::is_invocable_v<F&, Solace::StringView, Context const&>>>
 		Argument(Solace::StringLiteral name,
 				 Solace::StringLiteral description,
 				 F&& callback)
@@ -240,6 +537,7 @@ public:
 			swap(_name, rhs._name);
 			swap(_description, rhs._description);
 			swap(_callback, rhs._callback);
+			swap(_independent, rhs._independent);
 
             return (*this);
         }
@@ -250,6 +548,21 @@ public:
 
         bool isTrailing() const noexcept;
 
+		/**
+		 * Mark a trailing argument callback as independent: safe to be called concurrently for different values.
+		 * Values of an independent trailing argument are processed by up to Parser::concurrencyLimit() threads.
+		 * Values are processed in no particular order, but an error is always reported for the first failed value
+		 * by position in argv. Values following the failed one may or may not have been processed.
+		 * @param value True if the callback is safe to be called concurrently.
+		 * @return Reference to this for fluent interface.
+		 */
+		Argument& independent(bool value = true) noexcept {
+			_independent = value;
+			return *this;
+		}
+
+		bool isIndependent() const noexcept { return _independent; }
+
 		Solace::Optional<Error>
 		match(Solace::StringView const& value, Context const& c) const;
 
@@ -257,46 +570,153 @@ public:
         Solace::StringLiteral                               _name;
         Solace::StringLiteral                               _description;
 		std::function<Solace::Optional<Error> (Solace::StringView, Context const&)>    _callback;
+
+		//!< Flag to indicate if the callback can be called concurrently for different values.
+		bool												_independent{false};
     };
 
 
+    /**
+     * Declarative rule on presence of options of a command, such as "--port is required"
+     * or "--tls-key requires --tls-cert".
+     *
+     * Options are referred to by any of their names. A constraint is compiled into bit masks of option indices
+     * when it is given to a command, @see Command::constraints(), so options must be set first.
+     * Only the first Constraint::kMaxOptions options of a command can be constrained.
+     * A violation is reported with the name of the missing or conflicting option, as given to the constraint, as a tag.
+     */
+	struct Constraint {
+		enum class Kind : Solace::uint8 {
+			Required,		//!< The option must be given.
+			ExactlyOne,		//!< Exactly one of the options must be given.
+			AtMostOne,		//!< At most one of the options may be given.
+			DependsOn,		//!< If the option is given, all the other options must be given too.
+			ConflictsWith,	//!< If the option is given, none of the other options may be given.
+			Invalid			//!< Constraint refers to an unknown option.
+		};
+
+		/// Maximum number of options of a command that constraints can refer to.
+		static constexpr Solace::uint32 kMaxOptions = 64;
+
+		/// Bit set of options seen by a parse, by index of an option in the command.
+		using OptionMask = Solace::uint64;
+
+		static Constraint required(Solace::StringLiteral name) {
+			return {Kind::Required, name, {}};
+		}
+
+		static Constraint exactlyOne(std::initializer_list<Solace::StringLiteral> names) {
+			return {Kind::ExactlyOne, {}, names};
+		}
+
+		static Constraint atMostOne(std::initializer_list<Solace::StringLiteral> names) {
+			return {Kind::AtMostOne, {}, names};
+		}
+
+		static Constraint dependsOn(Solace::StringLiteral name, std::initializer_list<Solace::StringLiteral> names) {
+			return {Kind::DependsOn, name, names};
+		}
+
+		static Constraint conflictsWith(Solace::StringLiteral name,
+										std::initializer_list<Solace::StringLiteral> names) {
+			return {Kind::ConflictsWith, name, names};
+		}
+
+		Constraint(Kind kind, Solace::StringLiteral subject, std::initializer_list<Solace::StringLiteral> others)
+			: _kind{kind}
+			, _subject{subject}
+			, _others{others}
+		{}
+
+		Kind kind() const noexcept { return _kind; }
+
+		/**
+		 * Resolve option names into bit masks.
+		 * @param options Options of the command the constraint is given to.
+		 * @return False if the constraint refers to an unknown option, or an option past the first kMaxOptions.
+		 * Such a constraint becomes Kind::Invalid and fails every parse.
+		 */
+		bool compile(std::vector<Option> const& options);
+
+		/**
+		 * Check the constraint against a set of options seen by a parse.
+		 * @param seen Bit set of options given in the command line.
+		 * @return Error describing the violation, if any.
+		 */
+		Solace::Optional<Error> check(OptionMask seen) const noexcept;
+
+	private:
+		/// Name of the other option, in the order given, which bit is in the mask after skipping the given number.
+		Solace::StringLiteral nameOf(OptionMask mask, size_t skip) const noexcept;
+
+	private:
+		Kind								_kind;
+		Solace::StringLiteral				_subject;
+		std::vector<Solace::StringLiteral>	_others;
+
+		OptionMask							_subjectMask{0};
+		OptionMask							_othersMask{0};
+
+		/// Bit of each of the other options, in the order they have been named.
+		std::vector<OptionMask>				_otherBits;
+
+		/// Option name the constraint failed to resolve, used as a tag of the error.
+		Solace::StringLiteral				_unknownName;
+	};
+
+
     /**
      * Command for CLI
+     *
+     * An action of a command is either synchronous: a callable returning Result<void, Error>,
+     * or asynchronous: a callable taking (Executor&, CancellationToken const&, Completion) that schedules its work
+     * on the executor and reports the result by calling completion exactly once.
      */
     class Command {
     public:
 
         using CommandDict = std::map<Solace::StringView, Command>;
 		using Action = std::function<Solace::Result<void, Error>()>;
+		using AsyncAction = std::function<void(Executor&, CancellationToken const&, Completion)>;
+
+		/// Function building the body of a lazy command, @see Command::lazy().
+		using Factory = std::function<Solace::Result<Command, Error>()>;
+
+		/// Check if a callable is an asynchronous action.
+		template<typename F>
+		static constexpr bool IsAsyncAction = std::is_invocable_v<F&, Executor&, CancellationToken const&, Completion>;
 
         template<typename F>
 		Command(Solace::StringView description, F&& f) noexcept(std::is_nothrow_move_constructible_v<F>)
 			: _description{Solace::mv(description)}
-			, _callback{Solace::fwd<F>(f)}
 			, _options{}
-        {}
+        {
+			action(Solace::fwd<F>(f));
+		}
 
         template<typename F>
         Command(Solace::StringView description,
                 F&& f,
 				std::initializer_list<Option> options)
 			: _description{Solace::mv(description)}
-			, _callback{Solace::fwd<F>(f)}
 			, _options{options}
 			, _commands{}
 			, _arguments{}
-		{}
+		{
+			action(Solace::fwd<F>(f));
+		}
 
         template<typename F>
         Command(Solace::StringView description,
                 std::initializer_list<Argument> arguments,
 				F&& f)
 			: _description{Solace::mv(description)}
-			, _callback{Solace::fwd<F>(f)}
 			, _options{}
 			, _commands{}
 			, _arguments{arguments}
-        {}
+        {
+			action(Solace::fwd<F>(f));
+		}
 
         template<typename F>
         Command(Solace::StringView description,
@@ -304,11 +724,41 @@ public:
                 F&& f,
 				std::initializer_list<Option> options)
 			: _description{Solace::mv(description)}
-			, _callback{Solace::fwd<F>(f)}
 			, _options{options}
 			, _commands{}
 			, _arguments{arguments}
-		{}
+		{
+			action(Solace::fwd<F>(f));
+		}
+
+		/**
+		 * Construct a command which body is built by a factory when the command is first selected.
+		 * Only the description is kept until then, so listing the command in help does not build it.
+		 * The factory is called at most once, even if the command is selected by several threads at the same time.
+		 * @param description Human readable description of the command.
+		 * @param factory Function that builds the command with its options, arguments and sub-commands.
+		 * It returns either a Command or a Result<Command, Error> if building the command can fail.
+		 */
+		template<typename F>
+		static Command lazy(Solace::StringView description, F&& factory) {
+			if constexpr (std::is_same_v<std::decay_t<std::invoke_result_t<F&>>, Command>) {
+				return lazyCommand(description, [f = Solace::fwd<F>(factory)]() mutable
+						-> Solace::Result<Command, Error> {
+					return Solace::Ok(f());
+				});
+			} else {
+				return lazyCommand(description, Factory{Solace::fwd<F>(factory)});
+			}
+		}
+
+		/// Check if the body of this command is built by a factory on first use.
+		bool isLazy() const noexcept { return static_cast<bool>(_lazy); }
+
+		/**
+		 * Get the command to parse: this command, or the command built by the factory of a lazy command.
+		 * The built command, or the error of its factory, is shared by all copies of a lazy command.
+		 */
+		Solace::Result<Command const*, Error> resolve() const;
 
 
         Command& swap(Command& rhs) noexcept {
@@ -316,9 +766,12 @@ public:
 
 			swap(_description, rhs._description);
 			swap(_callback, rhs._callback);
+			swap(_asyncCallback, rhs._asyncCallback);
 			swap(_options, rhs._options);
 			swap(_commands, rhs._commands);
 			swap(_arguments, rhs._arguments);
+			swap(_constraints, rhs._constraints);
+			swap(_lazy, rhs._lazy);
 
             return (*this);
         }
@@ -335,33 +788,132 @@ public:
             return *this;
         }
 
+		/**
+		 * Set options of this command, moving them into place.
+		 * Elements of an initializer_list are const and have to be copied, while
+		 * options given as temporaries are moved: \code cmd.options(Option{...}, Option{...}) \endcode
+		 */
+		template<typename... Options,
+				 typename = std::enable_if_t<(sizeof...(Options) > 0) && (std::is_same_v<Options, Option> && ...)>>
+		Command& options(Options&&... options) {
+			_options.clear();
+			_options.reserve(sizeof...(Options));
+			(_options.emplace_back(Solace::mv(options)), ...);
+
+			return *this;
+		}
+
+		/// Set options of this command built at run time, moving them into place.
+		Command& options(std::vector<Option>&& options) noexcept {
+			_options = Solace::mv(options);
+			return *this;
+		}
+
         const CommandDict&  commands() const noexcept  { return _commands; }
         Command& commands(std::initializer_list<std::pair<Solace::StringView const, Command>> commands) {
             _commands = commands;
             return *this;
         }
 
+		/**
+		 * Add a sub-command constructed in place.
+		 * @param name Name of the sub-command.
+		 * @param args Arguments of a Command constructor, or a Command to move.
+		 * @return Reference to the new sub-command to be configured further.
+		 */
+		template<typename... Args>
+		Command& addCommand(Solace::StringView name, Args&&... args) {
+			auto const [it, inserted] = _commands.try_emplace(name, Solace::fwd<Args>(args)...);
+			if (!inserted) {  // Arguments are not consumed by try_emplace if the name is taken: the last command wins
+				it->second = Command{Solace::fwd<Args>(args)...};
+			}
+
+			return it->second;
+		}
+
         const std::vector<Argument>& arguments() const noexcept           { return _arguments; }
         Command& arguments(std::initializer_list<Argument> arguments) {
             _arguments = arguments;
             return *this;
         }
 
+		/// Set positional arguments of this command, moving them into place. @see options(Options&&...)
+		template<typename... Arguments,
+				 typename = std::enable_if_t<(sizeof...(Arguments) > 0) &&
+											 (std::is_same_v<Arguments, Argument> && ...)>>
+		Command& arguments(Arguments&&... arguments) {
+			_arguments.clear();
+			_arguments.reserve(sizeof...(Arguments));
+			(_arguments.emplace_back(Solace::mv(arguments)), ...);
+
+			return *this;
+		}
+
+		std::vector<Constraint> const& constraints() const noexcept        { return _constraints; }
+
+		/**
+		 * Set constraints on presence of options of this command.
+		 * Constraints are checked after options of the command have been parsed, in the order given.
+		 * Options must be set before the constraints that refer to them: naming an unknown option is asserted here,
+		 * and in release builds fails every parse with InvalidInput.
+		 */
+		Command& constraints(std::initializer_list<Constraint> constraints);
+
+		/**
+		 * Check constraints of this command.
+		 * @param seen Bit set of options of this command given in the command line.
+		 * @return Error of the first violated constraint, if any.
+		 */
+		Solace::Optional<Error> checkConstraints(Constraint::OptionMask seen) const noexcept;
+
+        /**
+         * Get the action of this command.
+         * For asynchronous commands the action runs on an InlineExecutor and blocks until completion.
+         */
         Action action() const {
             return _callback;
         }
 
         template<typename F>
         Command& action(F&& f) {
-			_callback = Solace::fwd<F>(f);
+			if constexpr (IsAsyncAction<F>) {
+				_asyncCallback = Solace::fwd<F>(f);
+				_callback = blockingAction(_asyncCallback);
+			} else {
+				_callback = Solace::fwd<F>(f);
+				_asyncCallback = nullptr;
+			}
+
             return *this;
         }
 
+		/// Check if the action of this command is asynchronous.
+		bool isAsync() const noexcept { return static_cast<bool>(_asyncCallback); }
+
+		/**
+		 * Run the action of this command on an executor.
+		 * Synchronous actions are posted to the executor, asynchronous actions are given the executor to use.
+		 * An action is not started if the token is already cancelled.
+		 * @param executor Executor to run the action on.
+		 * @param cancellation Token to cancel the action.
+		 * @param completion Handler to be called exactly once with the result of the action.
+		 */
+		void dispatch(Executor& executor, CancellationToken const& cancellation, Completion completion) const;
+
+    private:
+
+		/// Wrap an asynchronous action into a synchronous one that waits for its completion.
+		static Action blockingAction(AsyncAction action);
+
+		static Command lazyCommand(Solace::StringView description, Factory factory);
 
     private:
         Solace::StringView      _description;
         Action                  _callback;
 
+		/// Asynchronous action. Empty if the action of the command is synchronous.
+		AsyncAction				_asyncCallback;
+
         /// Options / flags that the command accepts.
         std::vector<Option>   _options;
 
@@ -370,6 +922,14 @@ public:
 
         /// Mandatory positional arguments
         std::vector<Argument> _arguments;
+
+		/// Compiled constraints on presence of options
+		std::vector<Constraint>	_constraints;
+
+		struct LazyBody;
+
+		/// Factory and the command it has built. Null if the command is not lazy.
+		std::shared_ptr<LazyBody>	_lazy;
     };
 
 
@@ -387,6 +947,14 @@ public:
     Parser(Parser const& rhs) = delete;
     Parser& operator= (Parser const& rhs) = delete;
 
+	/**
+	 * Move the command tree of another parser into this one.
+	 * Sub-commands keep their addresses, but pointers to the top level command of rhs,
+	 * as well as caches and servers referring to rhs, are invalidated.
+	 */
+	Parser(Parser&& rhs) = default;
+	Parser& operator= (Parser&& rhs) = default;
+
     /**
      * Construct default command line parser.
      *
@@ -406,6 +974,8 @@ public:
         using std::swap;
         swap(_prefix, rhs._prefix);
         swap(_valueSeparator, rhs._valueSeparator);
+        swap(_concurrencyLimit, rhs._concurrencyLimit);
+        swap(_multiCall, rhs._multiCall);
         swap(_defaultAction, rhs._defaultAction);
 
         return (*this);
@@ -431,12 +1001,88 @@ public:
 
     /**
      * Parse command line arguments and process all the flags.
-     * @param argc Number of command line arguments including name of the program at argv[0]
-     * @param argv An array of string that represent command line argument tokens.
+     * @param args An array of string that represent command line argument tokens, including name of the program.
+     * @param pass Parsing pass. Startup-only options are ignored when parsing for Pass::Reload.
+     * @return Result of parsing: Either a pointer to the parser or an error.
+     */
+	Solace::Result<ParseResult, Error>
+	parse(Solace::ArrayView<const char*> args, Pass pass = Pass::Startup) const;
+
+    /**
+     * Parse command line arguments given in a transient buffer.
+     * String values bound by options and arguments are copied into the arena so they outlive the args buffer.
+     * @param args An array of string that represent command line argument tokens, including name of the program.
+     * @param arena An arena to own copies of string values. @see StringArena for lifetime rules.
+     * @param pass Parsing pass. Startup-only options are ignored when parsing for Pass::Reload.
+     * @return Result of parsing: Either a pointer to the parser or an error.
+     */
+	Solace::Result<ParseResult, Error>
+	parse(Solace::ArrayView<const char*> args, StringArena& arena, Pass pass = Pass::Startup) const;
+
+    /**
+     * Parse command line arguments recording applied values into a trace, so that the parse can be replayed.
+     * @see ParseCache
+     * @param args An array of string that represent command line argument tokens, including name of the program.
+     * @param trace A trace to record into.
+     * @param arena An optional arena to own copies of string values.
+     * @param pass Parsing pass. Startup-only options are ignored when parsing for Pass::Reload.
      * @return Result of parsing: Either a pointer to the parser or an error.
      */
 	Solace::Result<ParseResult, Error>
-    parse(Solace::ArrayView<const char*> args) const;
+	parse(Solace::ArrayView<const char*> args, ParseTrace& trace, StringArena* arena, Pass pass = Pass::Startup) const;
+
+    /**
+     * Parse command line arguments and resolve the command to run without getting its action.
+     * @param args An array of string that represent command line argument tokens, including name of the program.
+     * @param pass Parsing pass. Startup-only options are ignored when parsing for Pass::Reload.
+     * @return Command selected by the command line or an error.
+     */
+	Solace::Result<Command const*, Error>
+	resolve(Solace::ArrayView<const char*> args, Pass pass = Pass::Startup) const;
+
+	/**
+	 * Validate command line arguments collecting all the errors in a single pass.
+	 * Parsing is tolerant: an unknown option is skipped, an invalid value or a wrong number of arguments is reported
+	 * and parsing carries on from the next token. Parsing only stops early at an unknown sub-command.
+	 * Actions are not run and options with side effects other than setting a value, @see Option::isCacheable(),
+	 * such as help, version or deferred options, are not called. Values are still stored into bound variables.
+	 * @param args An array of string that represent command line argument tokens, including name of the program.
+	 * @param diagnostics List to report errors into. Errors are appended to the errors already in the list.
+	 * @param pass Parsing pass. Startup-only options are ignored when parsing for Pass::Reload.
+	 * @return Command selected by the command line, or the first error found if there are any
+	 * and the list had room for it.
+	 */
+	Solace::Result<Command const*, Error>
+	validate(Solace::ArrayView<const char*> args, Diagnostics& diagnostics, Pass pass = Pass::Startup) const;
+
+	/**
+	 * Run deferred tasks collected into Context::deferred by a parse that does not run them itself,
+	 * such as a replay of a cached parse. Tasks run concurrently, @see Option::deferred().
+	 * @param tasks Tasks to run.
+	 * @return Error of the first failed task, if any.
+	 */
+	Solace::Optional<Error> runDeferred(std::vector<DeferredTask>& tasks) const;
+
+	/**
+	 * Get the name of the top level command selected by argv[0] in multi-call mode, @see multiCall(bool).
+	 * @param args Command line arguments, including name of the program.
+	 * @return Basename of argv[0] if it names a top level command of a multi-call parser, empty string otherwise.
+	 */
+	Solace::StringView appletName(Solace::ArrayView<const char*> args) const noexcept;
+
+    /**
+     * Parse command line arguments and run selected action on an executor.
+     * Parsing is done in the calling thread, parse errors are reported via completion.
+     * Note that help and version requests are reported as an error with 'ParserError::NoError' code.
+     * @param args An array of string that represent command line argument tokens, including name of the program.
+     * @param executor Executor to run the action on.
+     * @param completion Handler to be called exactly once with the result of parsing and action.
+     * @param cancellation Token to cancel the action.
+     */
+	void dispatch(Solace::ArrayView<const char*> args,
+				  Executor& executor,
+				  Completion completion,
+				  CancellationToken const& cancellation = {}) const;
 
 
     /**
@@ -505,6 +1151,44 @@ public:
     }
 
 
+    /**
+     * Get maximum number of threads used to process values of independent trailing arguments
+     * and to run tasks of deferred options. Threads are the calling one and workers of ThreadPool::shared(),
+     * which are kept across parses.
+     * @see Argument::independent(), Option::deferred()
+     * @return Concurrency limit. Zero means the number of hardware threads.
+     */
+    Solace::uint32 concurrencyLimit() const noexcept { return _concurrencyLimit; }
+
+    /**
+     * Set maximum number of threads used to process values of independent trailing arguments
+     * and to run tasks of deferred options.
+     * @param value New concurrency limit. One disables concurrent processing, zero means the number of hardware threads.
+     * @return Reference to this for fluent interface.
+     */
+    Parser& concurrencyLimit(Solace::uint32 value) noexcept {
+        _concurrencyLimit = value;
+        return *this;
+    }
+
+	/// Check if the basename of argv[0] selects the command to start parsing from, @see multiCall(bool).
+	bool isMultiCall() const noexcept { return _multiCall; }
+
+	/**
+	 * Enable multi-call mode, for a single binary installed under the names of its top level commands.
+	 * If the basename of argv[0] names a top level command, parsing starts from that command,
+	 * as if the binary was called with the command name as the first argument:
+	 * `/bin/ls -l` is parsed as `tool ls -l`. Other names are parsed as usual.
+	 * Pre-scanned options, such as help and version, are scoped to the selected command.
+	 * @param value True to enable multi-call mode.
+	 * @return Reference to this for fluent interface.
+	 */
+	Parser& multiCall(bool value = true) noexcept {
+		_multiCall = value;
+		return *this;
+	}
+
+
     /**
      * Get human readable description of the application, dispayed by help and version commands.
      * @return Human readable application description string.
@@ -529,6 +1213,22 @@ public:
         return *this;
     }
 
+	/// Set top level options, moving them into place. @see Command::options(Options&&...)
+	template<typename... Options,
+			 typename = std::enable_if_t<(sizeof...(Options) > 0) && (std::is_same_v<Options, Option> && ...)>>
+	Parser& options(Options&&... options) {
+		_defaultAction.options(Solace::mv(options)...);
+
+		return *this;
+	}
+
+	/// Set top level options built at run time, moving them into place.
+	Parser& options(std::vector<Option>&& options) noexcept {
+		_defaultAction.options(Solace::mv(options));
+
+		return *this;
+	}
+
     Command::CommandDict const& commands() const noexcept        { return _defaultAction.commands(); }
     Parser& commands(std::initializer_list<Command::CommandDict::value_type> commands) {
         _defaultAction.commands(commands);
@@ -536,6 +1236,12 @@ public:
         return *this;
     }
 
+	/// Add a top level command constructed in place. @see Command::addCommand()
+	template<typename... Args>
+	Command& addCommand(Solace::StringView name, Args&&... args) {
+		return _defaultAction.addCommand(name, Solace::fwd<Args>(args)...);
+	}
+
     const std::vector<Argument>& arguments() const noexcept       { return _defaultAction.arguments(); }
     Parser& arguments(std::initializer_list<Argument> arguments) {
         _defaultAction.arguments(arguments);
@@ -543,6 +1249,22 @@ public:
         return *this;
     }
 
+	/// Set top level positional arguments, moving them into place. @see Command::arguments(Arguments&&...)
+	template<typename... Arguments,
+			 typename = std::enable_if_t<(sizeof...(Arguments) > 0) && (std::is_same_v<Arguments, Argument> && ...)>>
+	Parser& arguments(Arguments&&... arguments) {
+		_defaultAction.arguments(Solace::mv(arguments)...);
+
+		return *this;
+	}
+
+	/// Set constraints on presence of top level options, @see Command::constraints().
+	Parser& constraints(std::initializer_list<Constraint> constraints) {
+		_defaultAction.constraints(constraints);
+
+		return *this;
+	}
+
     Command&        defaultAction() noexcept        { return _defaultAction; }
     Command const&  defaultAction() const noexcept  { return _defaultAction; }
 
@@ -562,6 +1284,12 @@ private:
     /// Value separator
     char            _valueSeparator;
 
+    /// Maximum number of threads processing values of independent arguments
+    Solace::uint32  _concurrencyLimit{0};
+
+	/// Flag to indicate if the basename of argv[0] selects a top level command
+	bool			_multiCall{false};
+
     /// Default action to be produced when no other commands specified.
     Command         _defaultAction;
 };
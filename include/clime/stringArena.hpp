@@ -0,0 +1,143 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/stringArena.hpp
+ *	@brief		Bump allocator for string values that must outlive transient input buffers.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_STRINGARENA_HPP
+#define CLIME_STRINGARENA_HPP
+
+#include <solace/stringView.hpp>
+
+#include <memory>
+#include <vector>
+
+
+namespace clime {
+
+/**
+ * String arena to own copies of values parsed from a transient buffer.
+ *
+ * StringView values bound by a parser point directly into argv, which is fine as long as argv outlives the values.
+ * When command line comes from a network buffer or a temporary file read, the parser can be given an arena
+ * (@see Parser::parse(args, arena)) to copy values into. Copies are bump-allocated from fixed-size blocks.
+ *
+ * Lifetime rules:
+ *  - Values copied into the arena remain valid until reset() is called or the arena is destroyed.
+ *  - An arena must not be reset while a parse using it is in progress, and must not be shared by concurrent parses.
+ * Debug builds assert these rules and poison released memory so that dangling values are easy to spot.
+ */
+class StringArena {
+public:
+	using size_type = Solace::StringView::size_type;
+
+	/// Default size of a memory block.
+	static constexpr size_type kDefaultBlockSize = 4096;
+
+public:
+
+	~StringArena();
+
+	StringArena(StringArena const&) = delete;
+	StringArena& operator= (StringArena const&) = delete;
+
+	StringArena(StringArena&& rhs) noexcept = default;
+	StringArena& operator= (StringArena&& rhs) noexcept = default;
+
+	/**
+	 * Construct an arena.
+	 * @param blockSize Size of memory block to allocate. Values larger then block size get a dedicated block.
+	 */
+	explicit StringArena(size_type blockSize = kDefaultBlockSize) noexcept;
+
+	/**
+	 * Copy a string into the arena.
+	 * @param value A string to copy.
+	 * @return View of the null-terminated copy owned by the arena.
+	 */
+	Solace::StringView copy(Solace::StringView value);
+
+	/**
+	 * Release all the values allocated since the last reset.
+	 * The first block is kept for reuse, so repeated parses of similar input don't allocate.
+	 */
+	void reset() noexcept;
+
+	/// Check if the given string is owned by this arena.
+	bool owns(Solace::StringView value) const noexcept;
+
+	/// Number of bytes used by values since the last reset.
+	size_type used() const noexcept { return _used; }
+
+	/// Number of bytes in all the allocated blocks.
+	size_type capacity() const noexcept { return _capacity; }
+
+	/// Mark the begining of a parse using this arena. Used to check lifetime rules in debug builds.
+	void beginParse() noexcept;
+
+	/// Mark the end of a parse using this arena.
+	void endParse() noexcept;
+
+	/// Scope of a parse using an arena: the parse ends when the scope is left, even by an exception.
+	class ParseScope {
+	public:
+		/// Begin a parse using the given arena, if any.
+		explicit ParseScope(StringArena* arena) noexcept
+			: _arena{arena}
+		{
+			if (_arena) {
+				_arena->beginParse();
+			}
+		}
+
+		~ParseScope() {
+			if (_arena) {
+				_arena->endParse();
+			}
+		}
+
+		ParseScope(ParseScope const&) = delete;
+		ParseScope& operator= (ParseScope const&) = delete;
+
+	private:
+		StringArena*	_arena;
+	};
+
+private:
+
+	struct Block {
+		std::unique_ptr<char[]>	data;
+		size_type				size;
+	};
+
+	size_type				_blockSize;
+
+	/// Bytes used in the current(last) block.
+	size_type				_blockUsed{0};
+
+	size_type				_used{0};
+	size_type				_capacity{0};
+
+	std::vector<Block>		_blocks;
+
+	/// Number of parses currently using the arena.
+	size_type				_activeParses{0};
+};
+
+}  // End of namespace clime
+#endif  // CLIME_STRINGARENA_HPP
@@ -0,0 +1,193 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime: Command line arguments parser
+ *	@file		clime/threadPool.hpp
+ *	@brief		Fixed size pool of worker threads and concurrent loops over it.
+ ******************************************************************************/
+#pragma once
+#ifndef CLIME_THREADPOOL_HPP
+#define CLIME_THREADPOOL_HPP
+
+#include "executor.hpp"
+
+#include <solace/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace clime {
+
+/**
+ * A fixed size pool of worker threads executing posted tasks in FIFO order.
+ * Tasks posted before the pool is destroyed are completed before destructor returns.
+ * A task must not throw: as with std::thread, an exception escaping a task terminates the process.
+ */
+class ThreadPool final : public Executor {
+public:
+	using size_type = Solace::uint32;
+
+	~ThreadPool() override {
+		{
+			std::lock_guard<std::mutex> lock{_lock};
+			_stopping = true;
+		}
+		_hasWork.notify_all();
+
+		for (auto& worker : _workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator= (ThreadPool const&) = delete;
+
+	/**
+	 * Construct a pool of worker threads.
+	 * @param nbWorkers Number of worker threads. Zero means the number of hardware threads.
+	 */
+	explicit ThreadPool(size_type nbWorkers = 0) {
+		if (nbWorkers == 0) {
+			nbWorkers = std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		_workers.reserve(nbWorkers);
+		for (size_type i = 0; i < nbWorkers; ++i) {
+			_workers.emplace_back([this]() { run(); });
+		}
+	}
+
+	/**
+	 * Process-wide pool shared by parses, with a worker per hardware thread. Created on the first use.
+	 * Parser runs independent argument values and deferred option tasks on it, @see forEachConcurrently().
+	 */
+	static ThreadPool& shared();
+
+	/// Number of worker threads in the pool.
+	size_type size() const noexcept { return static_cast<size_type>(_workers.size()); }
+
+	/// Schedule a task to be executed by one of the workers.
+	void post(Task task) override {
+		{
+			std::lock_guard<std::mutex> lock{_lock};
+			_tasks.emplace_back(Solace::mv(task));
+		}
+		_hasWork.notify_one();
+	}
+
+private:
+
+	void run() {
+		while (true) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock{_lock};
+				_hasWork.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+				if (_tasks.empty()) {  // Stopping and no more work
+					return;
+				}
+
+				task = Solace::mv(_tasks.front());
+				_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+private:
+	std::mutex					_lock;
+	std::condition_variable		_hasWork;
+	std::deque<Task>			_tasks;
+	bool						_stopping{false};
+
+	std::vector<std::thread>	_workers;
+};
+
+
+
+/**
+ * Call a body for each index in [0, count) using up to nbThreads threads, the calling thread being one of them.
+ * Indices are claimed in increasing order. A worker stops claiming once the body returns false.
+ *
+ * Helpers are posted to the executor and the call returns once all the helpers that have started are done.
+ * Helpers that start late, for example because the executor is busy with other work, return without running
+ * the body, so the loop never waits for the executor and may be used from tasks running on it.
+ * The body must not throw: it may be run by executor workers.
+ */
+template<typename F>
+void forEachConcurrently(Executor& executor, Solace::uint32 count, Solace::uint32 nbThreads, F&& body) {
+	struct Loop {
+		std::function<bool(Solace::uint32)>	body;
+		Solace::uint32						count;
+		std::atomic<Solace::uint32>			nextIndex{0};
+
+		std::mutex							lock;
+		std::condition_variable				helpersDone;
+		Solace::uint32						activeHelpers{0};
+		bool								isClosed{false};
+
+		void run() {
+			while (true) {
+				auto const index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+				if (index >= count || !body(index)) {
+					return;
+				}
+			}
+		}
+	};
+
+	// Note: Loop is shared with the helpers, as a helper may only start after the caller has returned
+	auto loop = std::make_shared<Loop>();
+	loop->body = std::ref(body);
+	loop->count = count;
+
+	nbThreads = std::min(nbThreads, count);
+	for (Solace::uint32 i = 1; i < nbThreads; ++i) {
+		executor.post([loop]() {
+			{
+				std::lock_guard<std::mutex> guard{loop->lock};
+				if (loop->isClosed) {
+					return;
+				}
+				loop->activeHelpers += 1;
+			}
+
+			loop->run();
+
+			std::lock_guard<std::mutex> guard{loop->lock};
+			loop->activeHelpers -= 1;
+			loop->helpersDone.notify_all();
+		});
+	}
+
+	loop->run();
+
+	std::unique_lock<std::mutex> guard{loop->lock};
+	loop->isClosed = true;
+	loop->helpersDone.wait(guard, [&loop]() { return loop->activeHelpers == 0; });
+}
+
+}  // End of namespace clime
+#endif  // CLIME_THREADPOOL_HPP
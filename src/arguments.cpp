@@ -20,278 +20,62 @@
 *******************************************************************************/
 
 #include "clime/parser.hpp"
+#include "clime/parseCache.hpp"
 #include "clime/parseUtils.hpp"
 
+#include <cstring>
+
 
 using namespace Solace;
 using namespace clime;
 
 
-namespace /* anonymous */ {
-
-Optional<Error>
-formatOptionalError(char const* SOLACE_UNUSED(inputType),
-					StringView name,
-					const char* SOLACE_UNUSED(expectedType),
-					StringView SOLACE_UNUSED(value)) noexcept {
-	return makeParserError(ParserError::OptionParsing, name);
-}
-
-
-template<typename T>
-Optional<Error>
-parseIntArgument(T* dest, StringView value, Parser::Context const& cntx) {
-	auto val = tryParse<T>(value);
-    if (val) {
-        *dest = static_cast<T>(val.unwrap());
-        return none;
-    }
-
-	return makeParserError(ParserError::OptionParsing, cntx.name);  // val.moveError();
-}
-
-
-
-Optional<Error>
-parseBoolean(bool* dest, StringView value) {
-    auto val = tryParse<bool>(value);
-    if (val) {
-        *dest = val.unwrap();
-        return none;
-    }
-
-	return val.moveError();
-}
-
-
-}  // anonymous namespace
-
+void
+Parser::Context::bind(StringView* dest, StringView value) const {
+	*dest = retain(value);
 
-Parser::Option::Option(std::initializer_list<StringLiteral> arg, StringLiteral desc, StringView* dest)
-	: Option{arg, desc, ArgumentValue::Required,
-		[dest](Optional<StringView> const& value, Context const&) -> Optional<Error> {
-            *dest = value.get();
-
-            return none;
-		}}
-{
-}
-
-
-Parser::Option::Option(std::initializer_list<StringLiteral> arg, StringLiteral desc, int8* dest)
-	: Option{arg, desc, ArgumentValue::Required,
-        [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-		}}
-{
-}
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, uint8* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
-}
-
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, int16* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
-}
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, uint16* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
+	if (trace) {
+		trace->storeView(dest, value, *this);
+	}
 }
 
 
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, int32* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
+void
+Parser::Context::record(void* dest, void const* value, size_t size) const noexcept {
+	trace->storeBytes(dest, value, size);
 }
 
 
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, uint32* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
-}
-
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, int64* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
-}
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, uint64* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) {
-                 return parseIntArgument(dest, value.get(), context);
-			 }}
-{
+Parser::Command const&
+Parser::Context::currentCommand() const noexcept {
+	return command ? *command : parser.defaultAction();
 }
 
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, float32* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) -> Optional<Error> {
-                char* pEnd = nullptr;
-                // FIXME(abbyssoul): not safe use of data
-                auto val = strtof(value.get().data(), &pEnd);
-
-                if (!pEnd || pEnd == value.get().data()) {  // No conversion has been done
-					return formatOptionalError("Option", context.name, "float32", value.get());
-                }
 
-                *dest = static_cast<float32>(val);
+Parser::Context::size_type
+Parser::Context::indexOf(StringView value) const noexcept {
+	auto const next = offset + 1;
+	if (next < argv.size() && argv[next] &&
+		value.data() >= argv[next] && value.data() <= argv[next] + std::strlen(argv[next])) {
+		return next;
+	}
 
-                return none;
-			}}
-{
+	return offset;
 }
 
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, float64* dest)
-	: Option{names, desc, ArgumentValue::Required,
-             [dest](Optional<StringView> const& value, Context const& context) -> Optional<Error> {
-                char* pEnd = nullptr;
-                // FIXME(abbyssoul): not safe use of data
-                auto val = strtod(value.get().data(), &pEnd);
-
-                if (!pEnd || pEnd == value.get().data()) {  // No conversion has been done
-					return formatOptionalError("Option", context.name, "float64", value.get());
-                }
 
-                *dest = static_cast<float64>(val);
-
-                return none;
-			 }}
-{
-}
-
-
-Parser::Option::Option(std::initializer_list<StringLiteral> names, StringLiteral desc, bool* dest)
-	: Option{names, desc, ArgumentValue::Optional,
-             [dest](Optional<StringView> const& value, Context const&) -> Optional<Error> {
-				if (value) {
-					return parseBoolean(dest, *value);
-                }
-
-                *dest = true;
-
-                return none;
-			}}
-{
-}
-
-
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, int8* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, uint8* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, int16* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, uint16* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, int32* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, uint32* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, int64* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, uint64* dest)
-	: Argument{name, description,
-			   [dest](StringView value, Context const& context) { return parseIntArgument(dest, value, context); }}
-
-{
-}
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, float32* dest)
-	: Argument{name, description,
-                [dest](StringView value, Context const& context) {
-                    char* pEnd = nullptr;
-                    // FIXME(abbyssoul): not safe use of data
-                    *dest = strtof(value.data(), &pEnd);
-
-                    return (!pEnd || pEnd == value.data())
-							   ? formatOptionalError("Argument", context.name, "float32", value)
-                               : none;
-			   }}
-{
-}
-
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, float64* dest)
-	: Argument{name, description,
-                [dest](StringView value, Context const& context) {
-                    char* pEnd = nullptr;
-                    // FIXME(abbyssoul): not safe use of data
-                    *dest = strtod(value.data(), &pEnd);
-
-                    return (!pEnd || pEnd == value.data())
-							   ? formatOptionalError("Argument", context.name, "float64", value)
-                               : none;
-			   }}
-{
-}
-
-
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, bool* dest)
-	: Argument{name, description, [dest](StringView value, Context const&) { return parseBoolean(dest, value); }}
-{
-}
+std::shared_ptr<std::string const>
+Parser::Option::joinChoices(ArrayView<const StringLiteral> names) {
+	std::string choices;
+	for (auto const& name : names) {
+		if (!choices.empty()) {
+			choices += '|';
+		}
 
+		choices.append(name.data(), name.size());
+	}
 
-Parser::Argument::Argument(StringLiteral name, StringLiteral description, StringView* dest)
-	: Argument{name, description, [dest](StringView value, Context const&) { *dest = value; return none; }}
-{
+	return std::make_shared<std::string const>(mv(choices));
 }
 
 
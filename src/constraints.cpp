@@ -0,0 +1,173 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/constraints.cpp
+ *
+*******************************************************************************/
+
+#include "clime/parser.hpp"
+
+#include <cassert>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace /* anonymous */ {
+
+using OptionMask = Parser::Constraint::OptionMask;
+
+
+/// Find index of an option with the given name, or number of options if there is no such option.
+size_t
+indexOfOption(std::vector<Parser::Option> const& options, StringView name) noexcept {
+	for (size_t i = 0; i < options.size(); ++i) {
+		if (options[i].isMatch(name)) {
+			return i;
+		}
+	}
+
+	return options.size();
+}
+
+
+bool
+hasMoreThanOne(OptionMask mask) noexcept {
+	return (mask & (mask - 1)) != 0;
+}
+
+}  // anonymous namespace
+
+
+bool
+Parser::Constraint::compile(std::vector<Option> const& options) {
+	_subjectMask = 0;
+	_othersMask = 0;
+	_otherBits.clear();
+
+	auto bitOf = [this, &options](StringLiteral name) -> OptionMask {
+		auto const index = indexOfOption(options, name);
+		if (index >= options.size() || index >= kMaxOptions) {
+			_kind = Kind::Invalid;
+			_unknownName = name;
+			return 0;
+		}
+
+		return OptionMask{1} << index;
+	};
+
+	bool const hasSubject = (_kind == Kind::Required || _kind == Kind::DependsOn || _kind == Kind::ConflictsWith);
+	if (hasSubject) {
+		_subjectMask = bitOf(_subject);
+		if (!_subjectMask) {
+			return false;
+		}
+	}
+
+	_otherBits.reserve(_others.size());
+	for (auto const& name : _others) {
+		auto const bit = bitOf(name);
+		if (!bit) {
+			return false;
+		}
+
+		_otherBits.push_back(bit);
+		_othersMask |= bit;
+	}
+
+	return true;
+}
+
+
+StringLiteral
+Parser::Constraint::nameOf(OptionMask mask, size_t skip) const noexcept {
+	for (size_t i = 0; i < _others.size(); ++i) {
+		if ((_otherBits[i] & mask) != 0 && skip-- == 0) {
+			return _others[i];
+		}
+	}
+
+	return {};
+}
+
+
+Optional<Error>
+Parser::Constraint::check(OptionMask seen) const noexcept {
+	bool const subjectSeen = (seen & _subjectMask) != 0;
+	auto const othersSeen = seen & _othersMask;
+
+	// Note: Tags are option names given to the constraint, so errors don't refer to memory owned by the parser
+	switch (_kind) {
+	case Kind::Required:
+		if (!subjectSeen) {
+			return makeParserError(ParserError::MissingOption, _subject);
+		}
+		break;
+	case Kind::ExactlyOne:
+		if (othersSeen == 0) {
+			return makeParserError(ParserError::MissingOption, nameOf(_othersMask, 0));
+		}
+		if (hasMoreThanOne(othersSeen)) {
+			return makeParserError(ParserError::ConflictingOptions, nameOf(othersSeen, 1));
+		}
+		break;
+	case Kind::AtMostOne:
+		if (hasMoreThanOne(othersSeen)) {
+			return makeParserError(ParserError::ConflictingOptions, nameOf(othersSeen, 1));
+		}
+		break;
+	case Kind::DependsOn:
+		if (subjectSeen && othersSeen != _othersMask) {
+			return makeParserError(ParserError::MissingOption, nameOf(_othersMask & ~othersSeen, 0));
+		}
+		break;
+	case Kind::ConflictsWith:
+		if (subjectSeen && othersSeen != 0) {
+			return makeParserError(ParserError::ConflictingOptions, nameOf(othersSeen, 0));
+		}
+		break;
+	case Kind::Invalid:
+		return makeParserError(ParserError::InvalidInput, _unknownName);
+	}
+
+	return none;
+}
+
+
+Parser::Command&
+Parser::Command::constraints(std::initializer_list<Constraint> constraints) {
+	_constraints = constraints;
+	for (auto& constraint : _constraints) {
+		[[maybe_unused]] bool const isValid = constraint.compile(_options);
+		assert(isValid && "Constraint refers to an unknown option");
+	}
+
+	return *this;
+}
+
+
+Optional<Error>
+Parser::Command::checkConstraints(Constraint::OptionMask seen) const noexcept {
+	for (auto const& constraint : _constraints) {
+		auto maybeViolation = constraint.check(seen);
+		if (maybeViolation) {
+			return maybeViolation;
+		}
+	}
+
+	return none;
+}
@@ -0,0 +1,81 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/dispatch.cpp
+ *
+*******************************************************************************/
+
+#include "clime/parser.hpp"
+
+#include <future>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+Parser::Command::Action
+Parser::Command::blockingAction(AsyncAction action) {
+	return [asyncAction = mv(action)]() -> Result<void, Error> {
+		InlineExecutor executor;
+		std::promise<Result<void, Error>> promise;
+		auto result = promise.get_future();
+
+		asyncAction(executor, CancellationToken{}, [&promise](Result<void, Error> actionResult) {
+			promise.set_value(mv(actionResult));
+		});
+
+		return result.get();
+	};
+}
+
+
+void
+Parser::Command::dispatch(Executor& executor, CancellationToken const& cancellation, Completion completion) const {
+	if (cancellation.isCancelled()) {
+		completion(makeParserError(ParserError::Cancelled, "dispatch"));
+		return;
+	}
+
+	if (_asyncCallback) {
+		_asyncCallback(executor, cancellation, mv(completion));
+		return;
+	}
+
+	executor.post([action = _callback, cancellation, handler = mv(completion)]() {
+		if (cancellation.isCancelled()) {  // Cancelled while waiting in the executor queue
+			handler(makeParserError(ParserError::Cancelled, "dispatch"));
+			return;
+		}
+
+		handler(action());
+	});
+}
+
+
+void
+Parser::dispatch(ArrayView<const char*> args,
+				 Executor& executor,
+				 Completion completion,
+				 CancellationToken const& cancellation) const {
+	auto maybeCommand = resolve(args);
+	if (!maybeCommand) {
+		completion(maybeCommand.moveError());
+		return;
+	}
+
+	maybeCommand.unwrap()->dispatch(executor, cancellation, mv(completion));
+}
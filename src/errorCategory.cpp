@@ -17,6 +17,8 @@
 
 #include <solace/string.hpp>
 
+#include <cstdio>
+
 using namespace Solace;
 using namespace clime;
 
@@ -27,28 +29,38 @@ const AtomValue clime::kParserErrorCatergory = atom("clime");
 
 namespace /*anonimous*/ {
 
-struct ParserErrorDomain final : public ErrorDomain {
-
-	StringView name() const noexcept override { return "CLI arguments"; }
+// Layout of a positioned error code: | argv index + 1 : 15 | value kind : 8 | error code : 8 |
+constexpr int kKindShift = 8;
+constexpr int kIndexShift = 16;
+constexpr uint32 kCodeMask = 0xFF;
+constexpr uint32 kMaxIndex = 0x7FFE;
+
+
+StringLiteral
+valueKindName(ValueKind kind) noexcept {
+	switch (kind) {
+	case ValueKind::Unknown:	return "";
+	case ValueKind::Flag:		return "true or false";
+	case ValueKind::Integer:	return "integer";
+	case ValueKind::Unsigned:	return "unsigned integer";
+	case ValueKind::Float:		return "number";
+	case ValueKind::String:		return "string";
+	case ValueKind::Duration:	return "duration";
+	case ValueKind::ByteSize:	return "byte size";
+	case ValueKind::Timestamp:	return "timestamp";
+	case ValueKind::Choice:		return "choice";
+	}
 
-	String message(int errCode) const noexcept override {
-		ParserError const code = static_cast<ParserError>(errCode);
+	return "";
+}
 
-		return makeString(codeToMessage(code));
-	}
 
+struct ParserErrorDomain final : public ErrorDomain {
 
-	StringLiteral codeToMessage(ParserError code) const noexcept {
-		switch (code) {
-		case ParserError::NoError:				return "not an error";
-		case ParserError::InvalidNumberOfArgs:	return " invalid number of arguments";
-		case ParserError::ValueExpected:		return " value is expected";
-		case ParserError::UnexpectedValue:		return " unexpected value";
-		case ParserError::InvalidInput:			return " invalid input";
-		case ParserError::OptionParsing:		return " error parsing option value";
-		}
+	StringView name() const noexcept override { return "CLI arguments"; }
 
-		return "unknown error";
+	String message(int errCode) const noexcept override {
+		return makeString(parserErrorMessage(static_cast<ParserError>(static_cast<uint32>(errCode) & kCodeMask)));
 	}
 };
 
@@ -63,3 +75,75 @@ Error
 clime::makeParserError(ParserError errorCode, StringView tag) noexcept {
 	return Error{kParserErrorCatergory, static_cast<int>(errorCode), tag};
 }
+
+
+Error
+clime::makeParserError(ParserError errorCode, uint32 argvIndex, StringView token, ValueKind expected) noexcept {
+	uint32 const position = (argvIndex < kMaxIndex) ? argvIndex + 1 : 0;
+	uint32 const code = (static_cast<uint32>(errorCode) & kCodeMask) |
+			(static_cast<uint32>(expected) << kKindShift) |
+			(position << kIndexShift);
+
+	return Error{kParserErrorCatergory, static_cast<int>(code), token};
+}
+
+
+ParserError
+clime::parserErrorCode(Error const& error) noexcept {
+	auto const code = static_cast<uint32>(error.value());
+
+	return static_cast<ParserError>((error.domain() == kParserErrorCatergory) ? (code & kCodeMask) : code);
+}
+
+
+ParserErrorInfo
+clime::parserErrorInfo(Error const& error) noexcept {
+	auto const code = static_cast<uint32>(error.value());
+	auto const position = (error.domain() == kParserErrorCatergory) ? (code >> kIndexShift) : 0;
+
+	return {parserErrorCode(error),
+			(position != 0) ? static_cast<ValueKind>((code >> kKindShift) & kCodeMask) : ValueKind::Unknown,
+			(position != 0) ? position - 1 : ParserErrorInfo::kNoPosition,
+			error.tag()};
+}
+
+
+StringLiteral
+clime::parserErrorMessage(ParserError code) noexcept {
+	switch (code) {
+	case ParserError::NoError:				return "not an error";
+	case ParserError::InvalidNumberOfArgs:	return " invalid number of arguments";
+	case ParserError::ValueExpected:		return " value is expected";
+	case ParserError::UnexpectedValue:		return " unexpected value";
+	case ParserError::InvalidInput:			return " invalid input";
+	case ParserError::OptionParsing:		return " error parsing option value";
+	case ParserError::Cancelled:			return " cancelled";
+	case ParserError::MissingOption:		return " required option missing";
+	case ParserError::ConflictingOptions:	return " conflicting options given";
+	}
+
+	return "unknown error";
+}
+
+
+size_t
+clime::formatParserError(Error const& error, char* buffer, size_t size) noexcept {
+	auto const tag = error.tag();
+	auto const tagLength = static_cast<int>(tag.size());
+	if (error.domain() != kParserErrorCatergory) {
+		return static_cast<size_t>(snprintf(buffer, size, "%.*s: error %d", tagLength, tag.data(), error.value()));
+	}
+
+	auto const info = parserErrorInfo(error);
+	auto const message = parserErrorMessage(info.code);
+	if (info.argvIndex == ParserErrorInfo::kNoPosition) {
+		return static_cast<size_t>(snprintf(buffer, size, "%.*s:%s", tagLength, tag.data(), message.data()));
+	}
+
+	auto const expected = valueKindName(info.expected);
+	return static_cast<size_t>(snprintf(buffer, size, "argv[%u] '%.*s':%s%s%s%s",
+										info.argvIndex, tagLength, tag.data(), message.data(),
+										expected.empty() ? "" : " (",
+										expected.data(),
+										expected.empty() ? "" : ")"));
+}
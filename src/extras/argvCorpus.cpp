@@ -0,0 +1,213 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/argvCorpus.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/argvCorpus.hpp"
+#include "clime/extras/mappedFile.hpp"
+
+#include <solace/posixErrorDomain.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+namespace /* anonymous */ {
+
+using size_type = ArgvCorpus::size_type;
+
+/// Record header: number of tokens and size of the tokens in bytes.
+constexpr size_t kRecordHeaderSize = 2 * sizeof(size_type);
+
+
+StringView tokenOf(char const* arg) noexcept {
+	return arg ? StringView{arg} : StringView{};
+}
+
+
+void encodeRecord(std::vector<char>& buffer, ArrayView<const char*> args) {
+	size_type size = 0;
+	for (auto arg : args) {
+		size += tokenOf(arg).size() + 1;
+	}
+
+	size_type const header[2] = {static_cast<size_type>(args.size()), size};
+	auto const headerBytes = reinterpret_cast<char const*>(header);
+	buffer.insert(buffer.end(), headerBytes, headerBytes + kRecordHeaderSize);
+
+	for (auto arg : args) {
+		auto const token = tokenOf(arg);
+		buffer.insert(buffer.end(), token.data(), token.data() + token.size());
+		buffer.push_back('\0');
+	}
+}
+
+
+Result<void, Error>
+writeFile(StringView path, int flags, std::vector<char> const& buffer) {
+	// Note: path may be a part of an argv token, so it is not necessarily null-terminated
+	auto const pathString = std::string{path.data(), path.size()};
+
+	int const fd = ::open(pathString.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | flags, 0644);
+	if (fd < 0) {
+		return makeErrno(path);
+	}
+
+	size_t written = 0;
+	while (written < buffer.size()) {
+		auto const n = ::write(fd, buffer.data() + written, buffer.size() - written);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			auto error = makeErrno(path);
+			close(fd);
+			return error;
+		}
+
+		written += static_cast<size_t>(n);
+	}
+
+	close(fd);
+	return Ok();
+}
+
+}  // anonymous namespace
+
+
+Result<ArgvCorpus, Error>
+ArgvCorpus::load(StringView path) {
+	auto maybeFile = MappedFile::open(path);
+	if (!maybeFile) {
+		return maybeFile.moveError();
+	}
+
+	auto maybeCorpus = decode(maybeFile.unwrap().view());
+	if (!maybeCorpus) {
+		return makeErrno(EINVAL, path);
+	}
+
+	return maybeCorpus;
+}
+
+
+Result<ArgvCorpus, Error>
+ArgvCorpus::decode(StringView data) {
+	ArgvCorpus corpus;
+	std::vector<const char*> args;
+
+	size_t i = 0;
+	while (i < data.size()) {
+		size_type header[2];
+		if (data.size() - i < kRecordHeaderSize) {
+			return makeErrno(EINVAL, "Truncated argv corpus record");
+		}
+
+		std::memcpy(header, data.data() + i, kRecordHeaderSize);
+		i += kRecordHeaderSize;
+
+		auto const nbTokens = header[0];
+		auto const size = header[1];
+		if (data.size() - i < size || (size > 0 && data[i + size - 1] != '\0')) {
+			return makeErrno(EINVAL, "Truncated argv corpus record");
+		}
+
+		args.clear();
+		for (auto const end = i + size; i < end; i += std::strlen(data.data() + i) + 1) {
+			args.push_back(data.data() + i);
+		}
+
+		if (args.size() != nbTokens) {
+			return makeErrno(EINVAL, "Malformed argv corpus record");
+		}
+
+		corpus.append(arrayView(args.data(), args.size()));
+	}
+
+	return Ok(mv(corpus));
+}
+
+
+void
+ArgvCorpus::append(ArrayView<const char*> args) {
+	auto const base = _tokens.data();
+	for (auto arg : args) {
+		auto const token = tokenOf(arg);
+		_offsets.push_back(static_cast<size_type>(_tokens.size()));
+		_tokens.insert(_tokens.end(), token.data(), token.data() + token.size());
+		_tokens.push_back('\0');
+	}
+
+	// Pointers to the tokens appended before are no longer valid once the buffer has been moved
+	if (_tokens.data() != base) {
+		_argv.clear();
+	}
+
+	for (auto i = _argv.size(); i < _offsets.size(); ++i) {
+		_argv.push_back(_tokens.data() + _offsets[i]);
+	}
+
+	_records.push_back(static_cast<size_type>(_argv.size()));
+}
+
+
+Result<void, Error>
+ArgvCorpus::save(StringView path) const {
+	std::vector<char> buffer;
+	buffer.reserve(_tokens.size() + size() * kRecordHeaderSize);
+	for (size_type i = 0; i < size(); ++i) {
+		encodeRecord(buffer, (*this)[i]);
+	}
+
+	return writeFile(path, O_TRUNC, buffer);
+}
+
+
+Result<void, Error>
+clime::extras::appendToCorpus(StringView path, ArrayView<const char*> args) {
+	std::vector<char> buffer;
+	encodeRecord(buffer, args);
+
+	return writeFile(path, O_APPEND, buffer);
+}
+
+
+void
+clime::extras::captureArgv(ArrayView<const char*> args) noexcept {
+	auto const path = std::getenv(kArgvCorpusEnv);
+	if (!path || !*path) {
+		return;
+	}
+
+	try {
+		appendToCorpus(path, args);
+	} catch (...) {
+		// Capture is best effort
+	}
+}
@@ -0,0 +1,291 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/commandChain.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/commandChain.hpp"
+#include "clime/parseCache.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+namespace /* anonymous */ {
+
+using size_type = ChainSegment::size_type;
+
+
+/// Mark segments that have not been run due to a failure of others.
+void
+skipSegments(std::vector<ChainSegment>& segments, size_type fromGroup) {
+	for (auto& segment : segments) {
+		if (segment.group >= fromGroup && !segment.error) {
+			segment.error = makeParserError(ParserError::Cancelled, "chain");
+		}
+	}
+}
+
+
+/// Options applied by a traced parse.
+std::vector<Parser::Option const*>
+appliedOptions(ParseTrace const& trace) {
+	std::vector<Parser::Option const*> options;
+	for (auto const& step : trace.steps()) {
+		if (step.kind == ParseTrace::Step::Kind::OptionCall || step.kind == ParseTrace::Step::Kind::OptionMark) {
+			options.push_back(step.option);
+		}
+	}
+
+	return options;
+}
+
+
+/// Check if two segments have applied any option in common.
+bool
+haveCommonOptions(std::vector<Parser::Option const*> const& lhs, std::vector<Parser::Option const*> const& rhs) {
+	return std::any_of(lhs.begin(), lhs.end(), [&rhs](Parser::Option const* option) {
+		return std::find(rhs.begin(), rhs.end(), option) != rhs.end();
+	});
+}
+
+
+/**
+ * Check segments of a group before anything runs.
+ * Segments of a group run concurrently while sharing variables bound by options,
+ * so neither a command nor an option may be given to more than one segment of the group.
+ * @return True if all the segments have been parsed and can run concurrently.
+ */
+bool
+validateGroup(Parser const& parser,
+			  std::vector<ChainSegment>& segments,
+			  std::vector<Parser::Command const*>& commands,
+			  size_type group) {
+	auto const groupSize = std::count_if(segments.begin(), segments.end(), [group](ChainSegment const& segment) {
+		return segment.group == group;
+	});
+
+	bool isValid = true;
+	std::vector<std::vector<Parser::Option const*>> options(segments.size());
+	for (size_type i = 0; i < segments.size(); ++i) {
+		auto& segment = segments[i];
+		if (segment.group != group) {
+			continue;
+		}
+
+		if (segment.args.size() < 2) {
+			segment.error = makeParserError(ParserError::InvalidNumberOfArgs, "Empty command segment");
+			isValid = false;
+			continue;
+		}
+
+		// Note: Options applied by the parse are learnt from its trace
+		ParseTrace trace;
+		auto maybeAction = parser.parse(arrayView(segment.args.data(), segment.args.size()), trace, nullptr);
+		if (!maybeAction) {
+			segment.error = maybeAction.moveError();
+			isValid = false;
+			continue;
+		}
+
+		if (groupSize > 1 && !trace.isReplayable()) {
+			segment.error = makeParserError(ParserError::UnexpectedValue,
+											"Options of a concurrent segment can not be traced");
+			isValid = false;
+			continue;
+		}
+
+		commands[i] = trace.command();
+		options[i] = appliedOptions(trace);
+		for (size_type j = 0; j < i; ++j) {
+			if (segments[j].group != group || !commands[j]) {
+				continue;
+			}
+
+			if (commands[j] == commands[i]) {
+				segment.error = makeParserError(ParserError::UnexpectedValue, "Command repeated in a concurrent group");
+				isValid = false;
+			} else if (haveCommonOptions(options[j], options[i])) {
+				segment.error = makeParserError(ParserError::UnexpectedValue, "Option repeated in a concurrent group");
+				isValid = false;
+			}
+		}
+	}
+
+	return isValid;
+}
+
+
+/**
+ * Parse segments of a group right before the group runs, so that bound variables hold values of its segments.
+ * @return True if all the segments have been parsed.
+ */
+bool
+resolveGroup(Parser const& parser,
+			 std::vector<ChainSegment>& segments,
+			 std::vector<Parser::Command const*>& commands,
+			 size_type group) {
+	bool isValid = true;
+	for (size_type i = 0; i < segments.size(); ++i) {
+		auto& segment = segments[i];
+		if (segment.group != group) {
+			continue;
+		}
+
+		auto maybeCommand = parser.resolve(arrayView(segment.args.data(), segment.args.size()));
+		if (!maybeCommand) {
+			segment.error = maybeCommand.moveError();
+			isValid = false;
+			continue;
+		}
+
+		commands[i] = maybeCommand.unwrap();
+	}
+
+	return isValid;
+}
+
+
+/**
+ * Run actions of a group concurrently and wait for all of them to complete.
+ * @return True if all the actions have succeeded.
+ */
+bool
+runGroup(std::vector<ChainSegment>& segments,
+		 std::vector<Parser::Command const*> const& commands,
+		 size_type group,
+		 Executor& executor,
+		 CancellationToken const& cancellation) {
+	std::mutex lock;
+	std::condition_variable allDone;
+	size_type pending = 0;
+	bool isSuccess = true;
+
+	for (size_type i = 0; i < segments.size(); ++i) {
+		if (segments[i].group != group) {
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard{lock};
+			pending += 1;
+		}
+
+		commands[i]->dispatch(executor, cancellation, [&, i](Result<void, Error> result) {
+			std::lock_guard<std::mutex> guard{lock};
+			if (!result) {
+				segments[i].error = result.moveError();
+				isSuccess = false;
+			}
+
+			pending -= 1;
+			allDone.notify_all();
+		});
+	}
+
+	std::unique_lock<std::mutex> guard{lock};
+	allDone.wait(guard, [&pending]() { return pending == 0; });
+
+	return isSuccess;
+}
+
+}  // anonymous namespace
+
+
+std::vector<ChainSegment>
+clime::extras::splitChain(ArrayView<const char*> args) {
+	std::vector<ChainSegment> segments;
+	if (args.empty()) {
+		return segments;
+	}
+
+	size_type group = 0;
+	segments.emplace_back();
+	segments.back().args.push_back(args[0]);
+
+	for (size_type i = 1; i < args.size(); ++i) {
+		auto const token = StringView{args[i]};
+		bool const isConcurrent = (token == kConcurrentSeparator);
+		bool const isSequential = (token == kSequentialSeparator);
+		if (!isConcurrent && !isSequential) {
+			segments.back().args.push_back(args[i]);
+			continue;
+		}
+
+		if (isSequential) {
+			group += 1;
+		}
+
+		segments.emplace_back();
+		segments.back().args.push_back(args[0]);
+		segments.back().group = group;
+	}
+
+	return segments;
+}
+
+
+std::vector<ChainSegment>
+clime::extras::runChain(Parser const& parser,
+						ArrayView<const char*> args,
+						Executor& executor,
+						CancellationToken const& cancellation) {
+	auto segments = splitChain(args);
+	if (segments.empty()) {
+		return segments;
+	}
+
+	std::vector<Parser::Command const*> commands(segments.size(), nullptr);
+	size_type const nbGroups = segments.back().group + 1;
+
+	// Validate the whole chain before running anything
+	bool isValid = true;
+	for (size_type group = 0; group < nbGroups; ++group) {
+		isValid &= validateGroup(parser, segments, commands, group);
+	}
+
+	if (!isValid) {
+		skipSegments(segments, 0);
+		return segments;
+	}
+
+	for (size_type group = 0; group < nbGroups; ++group) {
+		if (cancellation.isCancelled()) {
+			skipSegments(segments, group);
+			break;
+		}
+
+		// Bound variables hold values of the group parsed last, restore values of the group to run
+		if (!resolveGroup(parser, segments, commands, group)) {
+			skipSegments(segments, group);
+			break;
+		}
+
+		if (!runGroup(segments, commands, group, executor, cancellation)) {
+			skipSegments(segments, group + 1);
+			break;
+		}
+	}
+
+	return segments;
+}
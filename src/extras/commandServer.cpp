@@ -0,0 +1,564 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/commandServer.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/commandServer.hpp"
+#include "clime/threadPool.hpp"
+
+#include <solace/posixErrorDomain.hpp>
+#include <solace/output_utils.hpp>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+namespace /* anonymous */ {
+
+/// Redirect standard output streams into a buffer for the life time of the object.
+struct OutputCapture {
+	~OutputCapture() {
+		std::cout.flush();
+		std::cerr.flush();
+
+		std::cout.rdbuf(_coutBuffer);
+		std::cerr.rdbuf(_cerrBuffer);
+	}
+
+	explicit OutputCapture(std::ostream& dest)
+		: _coutBuffer{std::cout.rdbuf(dest.rdbuf())}
+		, _cerrBuffer{std::cerr.rdbuf(dest.rdbuf())}
+	{}
+
+	OutputCapture(OutputCapture const&) = delete;
+	OutputCapture& operator= (OutputCapture const&) = delete;
+
+private:
+	std::streambuf*	_coutBuffer;
+	std::streambuf*	_cerrBuffer;
+};
+
+
+Result<void, Error>
+writeAll(int fd, char const* data, size_t size) {
+	while (size > 0) {
+		auto written = send(fd, data, size, MSG_NOSIGNAL);
+		if (written < 0 && errno == ENOTSOCK) {
+			written = write(fd, data, size);
+		}
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return makeErrno("write");
+		}
+
+		data += written;
+		size -= static_cast<size_t>(written);
+	}
+
+	return Ok();
+}
+
+
+void appendToken(std::string& frame, StringView token) {
+	frame.append(token.data(), token.size());
+	frame.push_back(0);
+}
+
+
+bool
+makeAddress(sockaddr_un& address, StringView socketPath) noexcept {
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+	return true;
+}
+
+
+Result<int, Error>
+connectTo(StringView socketPath) {
+	sockaddr_un address{};
+	if (!makeAddress(address, socketPath)) {
+		return makeError(BasicError::InvalidInput, "socket path is too long");
+	}
+
+	int const fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return makeErrno("socket");
+	}
+
+	if (connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0) {
+		auto error = makeErrno("connect");
+		close(fd);
+		return error;
+	}
+
+	return Ok(fd);
+}
+
+
+/// Check if a socket file is left by a server that is no longer running: nobody accepts connections on it.
+bool
+isStaleSocket(sockaddr_un const& address) noexcept {
+	int const fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return false;
+	}
+
+	bool const isRefused = connect(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0 &&
+			errno == ECONNREFUSED;
+	close(fd);
+
+	return isRefused;
+}
+
+}  // anonymous namespace
+
+
+
+Result<bool, Error>
+FrameReader::fill() {
+	char chunk[4096];
+
+	while (true) {
+		auto const bytesRead = read(_fd, chunk, sizeof(chunk));
+		if (bytesRead < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return makeErrno("read");
+		}
+
+		if (bytesRead == 0) {
+			return Ok(false);
+		}
+
+		if (_buffer.size() + static_cast<size_t>(bytesRead) > kMaxFrameSize) {
+			return makeError(BasicError::InvalidInput, "frame is too large");
+		}
+
+		_buffer.append(chunk, static_cast<size_t>(bytesRead));
+		return Ok(true);
+	}
+}
+
+
+Result<Optional<FrameReader::size_type>, Error>
+FrameReader::nextToken() {
+	size_type searchFrom = _position;
+
+	while (true) {
+		auto const end = _buffer.find('\0', searchFrom);
+		if (end != std::string::npos) {
+			auto const tokenStart = _position;
+			_position = static_cast<size_type>(end + 1);
+
+			return Ok(Optional<size_type>{tokenStart});
+		}
+
+		searchFrom = static_cast<size_type>(_buffer.size());
+		auto hasMore = fill();
+		if (!hasMore) {
+			return hasMore.moveError();
+		}
+
+		if (!hasMore.unwrap()) {
+			if (_position != _buffer.size()) {
+				return makeError(BasicError::InvalidInput, "truncated frame");
+			}
+
+			return Ok(Optional<size_type>{});
+		}
+	}
+}
+
+
+Result<Optional<FrameReader::size_type>, Error>
+FrameReader::nextNumber(size_type maxValue) {
+	auto maybeToken = nextToken();
+	if (!maybeToken) {
+		return maybeToken.moveError();
+	}
+
+	auto& token = maybeToken.unwrap();
+	if (!token) {
+		return Ok(Optional<size_type>{});
+	}
+
+	uint64 value = 0;
+	char const* digit = _buffer.data() + *token;
+	if (*digit == 0) {
+		return makeError(BasicError::InvalidInput, "frame number expected");
+	}
+
+	for (; *digit != 0; ++digit) {
+		if (*digit < '0' || *digit > '9') {
+			return makeError(BasicError::InvalidInput, "frame number expected");
+		}
+
+		value = value * 10 + static_cast<uint64>(*digit - '0');
+		if (value > maxValue) {
+			return makeError(BasicError::InvalidInput, "frame number is too large");
+		}
+	}
+
+	return Ok(Optional<size_type>{static_cast<size_type>(value)});
+}
+
+
+Result<bool, Error>
+FrameReader::readRequest(std::vector<const char*>& args) {
+	// Previous frame is no longer needed
+	_buffer.erase(0, _position);
+	_position = 0;
+
+	auto maybeArgc = nextNumber(kMaxArgs);
+	if (!maybeArgc) {
+		return maybeArgc.moveError();
+	}
+
+	auto& argc = maybeArgc.unwrap();
+	if (!argc) {
+		return Ok(false);
+	}
+
+	// Offsets are collected first as the buffer may be reallocated while reading
+	std::vector<size_type> offsets;
+	offsets.reserve(*argc);
+	for (size_type i = 0; i < *argc; ++i) {
+		auto maybeToken = nextToken();
+		if (!maybeToken) {
+			return maybeToken.moveError();
+		}
+
+		auto& token = maybeToken.unwrap();
+		if (!token) {
+			return makeError(BasicError::InvalidInput, "truncated frame");
+		}
+
+		offsets.push_back(*token);
+	}
+
+	args.clear();
+	args.reserve(offsets.size());
+	for (auto offset : offsets) {
+		args.push_back(_buffer.data() + offset);
+	}
+
+	return Ok(true);
+}
+
+
+Result<CommandResponse, Error>
+FrameReader::readResponse() {
+	_buffer.erase(0, _position);
+	_position = 0;
+
+	auto maybeStatus = nextNumber(255);
+	if (!maybeStatus) {
+		return maybeStatus.moveError();
+	}
+
+	auto maybeLength = nextNumber(kMaxFrameSize);
+	if (!maybeLength) {
+		return maybeLength.moveError();
+	}
+
+	auto& status = maybeStatus.unwrap();
+	auto& length = maybeLength.unwrap();
+	if (!status || !length) {
+		return makeError(BasicError::InvalidInput, "truncated frame");
+	}
+
+	while (_buffer.size() - _position < *length) {
+		auto hasMore = fill();
+		if (!hasMore) {
+			return hasMore.moveError();
+		}
+
+		if (!hasMore.unwrap()) {
+			return makeError(BasicError::InvalidInput, "truncated frame");
+		}
+	}
+
+	CommandResponse response;
+	response.status = static_cast<int>(*status);
+	response.output.assign(_buffer, _position, *length);
+	_position += *length;
+
+	return Ok(mv(response));
+}
+
+
+Result<void, Error>
+clime::extras::writeRequest(int fd, ArrayView<const char*> args) {
+	std::string frame;
+	appendToken(frame, std::to_string(args.size()).c_str());
+	for (auto arg : args) {
+		appendToken(frame, arg);
+	}
+
+	return writeAll(fd, frame.data(), frame.size());
+}
+
+
+Result<void, Error>
+clime::extras::writeResponse(int fd, CommandResponse const& response) {
+	std::string frame;
+	appendToken(frame, std::to_string(response.status).c_str());
+	appendToken(frame, std::to_string(response.output.size()).c_str());
+	frame.append(response.output);
+
+	return writeAll(fd, frame.data(), frame.size());
+}
+
+
+
+Result<int, Error>
+clime::extras::listenUnixSocket(StringView socketPath) {
+	sockaddr_un address{};
+	if (!makeAddress(address, socketPath)) {
+		return makeError(BasicError::InvalidInput, "socket path is too long");
+	}
+
+	// Stale socket left by a previous instance of the server. Socket of a running server is left alone: bind fails.
+	struct stat pathStat;
+	if (stat(address.sun_path, &pathStat) == 0 && S_ISSOCK(pathStat.st_mode) && isStaleSocket(address)) {
+		unlink(address.sun_path);
+	}
+
+	int const fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		return makeErrno("socket");
+	}
+
+	if (bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0) {
+		auto error = makeErrno("bind");
+		close(fd);
+		return error;
+	}
+
+	// Requests run with privileges of the server: only its user may connect.
+	// Note: Permissions are set before listen(), so there is no window when others can connect.
+	if (chmod(address.sun_path, S_IRUSR | S_IWUSR) < 0) {
+		auto error = makeErrno("chmod");
+		close(fd);
+		unlink(address.sun_path);
+		return error;
+	}
+
+	if (listen(fd, SOMAXCONN) < 0) {
+		auto error = makeErrno("listen");
+		close(fd);
+		unlink(address.sun_path);
+		return error;
+	}
+
+	return Ok(fd);
+}
+
+
+int
+clime::extras::dispatchCommand(Parser const& parser, ArrayView<const char*> args) {
+	auto parseResult = parser.parse(args);
+	if (!parseResult) {
+		auto& error = parseResult.getError();
+		if (error) {  // Note: help and version requests are reported as 'NoError'
+			std::cerr << error << '\n';
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	auto actionResult = parseResult.unwrap()();
+	if (!actionResult) {
+		std::cerr << actionResult.getError() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+CommandResponse
+CommandServer::execute(ArrayView<const char*> args) {
+	std::lock_guard<std::mutex> lock{_dispatchLock};
+
+	CommandResponse response;
+	std::ostringstream output;
+	{
+		OutputCapture capture{output};
+
+		// A throwing action fails its request only, resident server keeps serving
+		try {
+			if (_reset) {
+				_reset();
+			}
+
+			response.status = dispatchCommand(_parser, args);
+		} catch (std::exception const& e) {
+			std::cerr << "Unhandled exception: " << e.what() << '\n';
+			response.status = EXIT_FAILURE;
+		} catch (...) {
+			std::cerr << "Unhandled exception\n";
+			response.status = EXIT_FAILURE;
+		}
+	}
+
+	response.output = output.str();
+
+	return response;
+}
+
+
+Result<void, Error>
+CommandServer::serve(int inFd, int outFd) {
+	FrameReader reader{inFd};
+	std::vector<const char*> args;
+
+	while (true) {
+		auto hasRequest = reader.readRequest(args);
+		if (!hasRequest) {
+			return hasRequest.moveError();
+		}
+
+		if (!hasRequest.unwrap()) {
+			return Ok();
+		}
+
+		auto const response = execute(arrayView(args.data(), args.size()));
+		auto writeResult = writeResponse(outFd, response);
+		if (!writeResult) {
+			return writeResult;
+		}
+	}
+}
+
+
+Result<void, Error>
+CommandServer::listen(StringView socketPath, size_type nbWorkers) {
+	auto maybeSocket = listenUnixSocket(socketPath);
+	if (!maybeSocket) {
+		return maybeSocket.moveError();
+	}
+
+	int const fd = maybeSocket.unwrap();
+	{
+		std::lock_guard<std::mutex> lock{_listenLock};
+		_listenFd = fd;  // stop() called before this point is seen by the loop below
+	}
+
+	{
+		ThreadPool workers{nbWorkers};
+		while (!_stopping) {
+			int const connection = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+			if (connection < 0) {
+				if (errno == EINTR || errno == ECONNABORTED) {
+					continue;
+				}
+
+				break;  // Listening socket has been shut down
+			}
+
+			workers.post([this, connection]() {
+				// IO errors only affect this connection, which is closed either way
+				try {
+					[[maybe_unused]] auto result = serve(connection, connection);
+				} catch (...) {
+					// Note: Exception escaping a pool task would terminate the server
+				}
+
+				close(connection);
+			});
+		}
+	}  // Wait for accepted connections to be served
+
+	{
+		std::lock_guard<std::mutex> lock{_listenLock};
+		_listenFd = -1;
+		_stopping = false;  // Server can listen again
+	}
+
+	close(fd);
+	unlink(std::string{socketPath.data(), socketPath.size()}.c_str());
+
+	return Ok();
+}
+
+
+void
+CommandServer::stop() noexcept {
+	std::lock_guard<std::mutex> lock{_listenLock};
+	_stopping = true;
+
+	// Descriptor is only closed by listen() after it has been reset under the lock
+	if (_listenFd >= 0) {
+		shutdown(_listenFd, SHUT_RDWR);
+	}
+}
+
+
+
+Result<int, Error>
+clime::extras::forwardCommand(StringView socketPath, ArrayView<const char*> args, std::ostream& output) {
+	auto maybeConnection = connectTo(socketPath);
+	if (!maybeConnection) {
+		return maybeConnection.moveError();
+	}
+
+	int const connection = maybeConnection.unwrap();
+	auto writeResult = writeRequest(connection, args);
+	if (!writeResult) {
+		close(connection);
+		return writeResult.moveError();
+	}
+
+	auto maybeResponse = FrameReader{connection}.readResponse();
+	close(connection);
+	if (!maybeResponse) {
+		return maybeResponse.moveError();
+	}
+
+	auto& response = maybeResponse.unwrap();
+	output.write(response.output.data(), static_cast<std::streamsize>(response.output.size()));
+
+	return Ok(response.status);
+}
@@ -0,0 +1,212 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/forkServer.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/forkServer.hpp"
+
+#include <solace/posixErrorDomain.hpp>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+namespace /* anonymous */ {
+
+/// Read whole content of a file from the begining.
+bool readAll(int fd, std::string& dest) {
+	auto const size = lseek(fd, 0, SEEK_END);
+	if (size < 0) {
+		return false;
+	}
+
+	dest.resize(static_cast<size_t>(size));
+	size_t offset = 0;
+	while (offset < dest.size()) {
+		auto const bytesRead = pread(fd, &dest[offset], dest.size() - offset, static_cast<off_t>(offset));
+		if (bytesRead < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (bytesRead <= 0) {
+			return false;
+		}
+
+		offset += static_cast<size_t>(bytesRead);
+	}
+
+	return true;
+}
+
+}  // anonymous namespace
+
+
+Result<pid_t, Error>
+ForkServer::spawn(int connection) {
+	// Make sure buffered output is not duplicated by the child
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(nullptr);
+
+	auto const pid = fork();
+	if (pid < 0) {
+		auto error = makeErrno("fork");
+		close(connection);
+		return error;
+	}
+
+	if (pid == 0) {
+		serveInChild(connection);
+	}
+
+	close(connection);
+	_children.push_back(pid);
+
+	return Ok(pid);
+}
+
+
+void
+ForkServer::serveInChild(int connection) {
+	// An exception must not unwind into the parent's accept loop and main() running in the child
+	try {
+		// Note: Only this thread exists in the child, so the descriptor is read without taking the lock
+		if (_listenFd >= 0) {
+			close(_listenFd);
+		}
+
+		FrameReader reader{connection};
+		std::vector<const char*> args;
+		auto hasRequest = reader.readRequest(args);
+		if (!hasRequest || !hasRequest.unwrap()) {
+			_exit(EXIT_FAILURE);
+		}
+
+		// Capture everything written to stdout and stderr by the action
+		int const output = memfd_create("clime-output", MFD_CLOEXEC);
+		if (output < 0 ||
+			dup2(output, STDOUT_FILENO) < 0 ||
+			dup2(output, STDERR_FILENO) < 0) {
+			_exit(EXIT_FAILURE);
+		}
+
+		CommandResponse response;
+		response.status = dispatchCommand(_parser, arrayView(args.data(), args.size()));
+
+		std::cout.flush();
+		std::cerr.flush();
+		fflush(nullptr);
+
+		if (!readAll(output, response.output)) {
+			_exit(EXIT_FAILURE);
+		}
+
+		auto writeResult = writeResponse(connection, response);
+		_exit(writeResult ? response.status : EXIT_FAILURE);
+	} catch (...) {
+		_exit(EXIT_FAILURE);
+	}
+}
+
+
+void
+ForkServer::reapChildren(bool wait) noexcept {
+	auto finished = [wait](pid_t pid) {
+		int status = 0;
+		pid_t result;
+		do {
+			result = waitpid(pid, &status, wait ? 0 : WNOHANG);
+		} while (result < 0 && errno == EINTR);
+
+		// Note: result < 0 means the child has been reaped by someone else
+		return result != 0;
+	};
+
+	_children.erase(std::remove_if(_children.begin(), _children.end(), finished), _children.end());
+}
+
+
+Result<void, Error>
+ForkServer::listen(StringView socketPath) {
+	auto maybeSocket = listenUnixSocket(socketPath);
+	if (!maybeSocket) {
+		return maybeSocket.moveError();
+	}
+
+	int const fd = maybeSocket.unwrap();
+	{
+		std::lock_guard<std::mutex> lock{_listenLock};
+		_listenFd = fd;  // stop() called before this point is seen by the loop below
+	}
+
+	while (!_stopping) {
+		int const connection = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+		reapChildren(false);
+
+		if (connection < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+
+			break;  // Listening socket has been shut down
+		}
+
+		auto child = spawn(connection);
+		if (!child) {  // Client observes failure as a closed connection
+			continue;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{_listenLock};
+		_listenFd = -1;
+		_stopping = false;  // Server can listen again
+	}
+
+	close(fd);
+	unlink(std::string{socketPath.data(), socketPath.size()}.c_str());
+	reapChildren(true);
+
+	return Ok();
+}
+
+
+void
+ForkServer::stop() noexcept {
+	std::lock_guard<std::mutex> lock{_listenLock};
+	_stopping = true;
+
+	// Descriptor is only closed by listen() after it has been reset under the lock
+	if (_listenFd >= 0) {
+		shutdown(_listenFd, SHUT_RDWR);
+	}
+}
@@ -0,0 +1,101 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/mappedFile.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/mappedFile.hpp"
+
+#include <solace/posixErrorDomain.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <limits>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+MappedFile::~MappedFile() {
+	if (_data) {
+		munmap(_data, _size);
+	}
+}
+
+
+Result<MappedFile, Error>
+MappedFile::open(StringView path) {
+	// Note: path may be a part of an argv token, so it is not necessarily null-terminated
+	auto const pathString = std::string{path.data(), path.size()};
+
+	int const fd = ::open(pathString.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return makeErrno(path);
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) < 0) {
+		auto error = makeErrno(path);
+		close(fd);
+		return error;
+	}
+
+	if (!S_ISREG(fileStat.st_mode)) {
+		close(fd);
+		return makeErrno(S_ISDIR(fileStat.st_mode) ? EISDIR : EINVAL, path);
+	}
+
+	// Content is viewed as a StringView, which can't address files of 4GiB and more
+	if (static_cast<uint64>(fileStat.st_size) > std::numeric_limits<size_type>::max()) {
+		close(fd);
+		return makeErrno(EFBIG, path);
+	}
+
+	MappedFile file;
+	file._path = path;
+	file._size = static_cast<size_type>(fileStat.st_size);
+
+	if (file._size > 0) {  // Empty files can't be mapped
+		void* const data = mmap(nullptr, file._size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			auto error = makeErrno(path);
+			close(fd);
+			return error;
+		}
+
+		file._data = data;
+
+		// Start reading the file in the background. It is only advice, so failure is not an error.
+		madvise(data, file._size, MADV_WILLNEED);
+#if defined(__linux__)
+		// Also populate the page cache ahead of the first access, in case the advice above is ignored
+		readahead(fd, 0, file._size);
+#endif
+	}
+
+	// Mapping remains valid after the descriptor is closed
+	close(fd);
+
+	return Ok(mv(file));
+}
@@ -0,0 +1,111 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/pathValidator.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/pathValidator.hpp"
+#include "clime/threadPool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <thread>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+Result<void, Error>
+PathValidator::ValidateTask::operator() (CancellationToken const& cancellation) const {
+	auto const results = validator->validate(cancellation);
+	auto maybeError = validator->_report(arrayView(results.data(), results.size()));
+	if (maybeError) {
+		return maybeError.move();
+	}
+
+	return Ok();
+}
+
+
+bool
+PathValidator::isRegistered(std::vector<Parser::DeferredTask> const& tasks) const noexcept {
+	return std::any_of(tasks.begin(), tasks.end(), [this](Parser::DeferredTask const& task) {
+		auto const validateTask = task.target<ValidateTask>();
+		return validateTask && validateTask->validator == this;
+	});
+}
+
+
+Optional<Error>
+PathValidator::collect(StringView path, Parser::Context const& cntx) {
+	// Note: Paths are whole argv tokens (or arena copies of them), so they are null-terminated
+	auto const value = cntx.retain(path);
+
+	// Values of an independent argument are collected concurrently
+	std::lock_guard<std::mutex> lock{_lock};
+
+	if (!cntx.deferred) {  // Nothing runs once parsing is done: check the path right away
+		PathStatus status{cntx.offset, value, 0};
+		status.errorCode = (access(status.path.data(), _accessMode) == 0) ? 0 : errno;
+
+		return _report(arrayView(static_cast<PathStatus const*>(&status), 1));
+	}
+
+	if (!isRegistered(*cntx.deferred)) {  // First path of a parse: validate once the whole command line is parsed
+		_paths.clear();
+		_parserConcurrencyLimit = cntx.parser.concurrencyLimit();
+		cntx.deferred->emplace_back(ValidateTask{this});
+	}
+
+	_paths.push_back({cntx.offset, value, 0});
+
+	return none;
+}
+
+
+std::vector<PathStatus>
+PathValidator::validate(CancellationToken const& cancellation) const {
+	auto results = _paths;
+	std::sort(results.begin(), results.end(), [](PathStatus const& lhs, PathStatus const& rhs) {
+		return lhs.position < rhs.position;
+	});
+
+	size_type const nbBatches = (static_cast<size_type>(results.size()) + _batchSize - 1) / _batchSize;
+	auto nbThreads = (_concurrencyLimit != 0) ? _concurrencyLimit : _parserConcurrencyLimit;
+	if (nbThreads == 0) {
+		nbThreads = std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	forEachConcurrently(ThreadPool::shared(), nbBatches, nbThreads, [&](size_type batch) {
+		auto const first = results.begin() + batch * _batchSize;
+		auto const last = results.begin() + std::min<size_t>((batch + 1) * _batchSize, results.size());
+		if (cancellation.isCancelled()) {
+			std::for_each(first, last, [](PathStatus& status) { status.errorCode = ECANCELED; });
+			return true;
+		}
+
+		std::for_each(first, last, [this](PathStatus& status) {
+			status.errorCode = (access(status.path.data(), _accessMode) == 0) ? 0 : errno;
+		});
+
+		return true;
+	});
+
+	return results;
+}
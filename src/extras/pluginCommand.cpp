@@ -0,0 +1,129 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/extras/pluginCommand.cpp
+ *
+*******************************************************************************/
+
+#include "clime/extras/pluginCommand.hpp"
+
+#include <solace/posixErrorDomain.hpp>
+
+#include <dlfcn.h>
+
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+namespace /* anonymous */ {
+
+using size_type = StringView::size_type;
+
+
+bool isBlank(char c) noexcept {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+size_type skipBlanks(StringView line, size_type i) noexcept {
+	while (i < line.size() && isBlank(line[i])) {
+		++i;
+	}
+
+	return i;
+}
+
+
+size_type skipWord(StringView line, size_type i) noexcept {
+	while (i < line.size() && !isBlank(line[i])) {
+		++i;
+	}
+
+	return i;
+}
+
+}  // anonymous namespace
+
+
+Result<std::vector<PluginEntry>, Error>
+clime::extras::parsePluginManifest(StringView manifest) {
+	std::vector<PluginEntry> entries;
+
+	size_type lineStart = 0;
+	while (lineStart < manifest.size()) {
+		auto lineEnd = lineStart;
+		while (lineEnd < manifest.size() && manifest[lineEnd] != '\n') {
+			++lineEnd;
+		}
+
+		auto const line = manifest.substring(lineStart, lineEnd);
+		lineStart = lineEnd + 1;
+
+		auto const nameStart = skipBlanks(line, 0);
+		if (nameStart == line.size() || line[nameStart] == '#') {
+			continue;
+		}
+
+		auto const nameEnd = skipWord(line, nameStart);
+		auto const pathStart = skipBlanks(line, nameEnd);
+		auto const pathEnd = skipWord(line, pathStart);
+		if (pathStart == pathEnd) {
+			return makeError(BasicError::InvalidInput, line);
+		}
+
+		auto const descriptionStart = skipBlanks(line, pathEnd);
+		auto descriptionEnd = line.size();
+		while (descriptionEnd > descriptionStart && isBlank(line[descriptionEnd - 1])) {
+			--descriptionEnd;
+		}
+
+		entries.push_back({line.substring(nameStart, nameEnd),
+						   line.substring(pathStart, pathEnd),
+						   line.substring(descriptionStart, descriptionEnd)});
+	}
+
+	return Ok(mv(entries));
+}
+
+
+Parser::Command
+clime::extras::pluginCommand(PluginEntry const& entry) {
+	return Parser::Command::lazy(entry.description, [entry]() -> Result<Parser::Command, Error> {
+		auto const path = std::string{entry.path.data(), entry.path.size()};
+
+		// The handle is never closed: actions of the command live in the shared object
+		auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (!handle) {
+			return makeError(BasicError::IOError, entry.path);
+		}
+
+		auto entryPoint = reinterpret_cast<PluginEntryPoint>(dlsym(handle, kPluginEntryPoint));
+		if (!entryPoint) {
+			return makeError(BasicError::InvalidInput, entry.path);
+		}
+
+		auto command = Parser::Command{entry.description, Parser::Command::Action{}};
+		if (entryPoint(&command) != 0) {
+			return makeError(BasicError::InvalidInput, entry.path);
+		}
+
+		return Ok(mv(command));
+	});
+}
@@ -57,8 +57,16 @@ void formatOption(std::ostream& output, char prefixChar, Parser::Option const& o
 
 	output << "  "
 		   << std::left << std::setw(26) << s.str()
-		   << option.description()
-		   << '\n';
+		   << option.description();
+
+	auto const choices = option.choices();
+	if (!choices.empty()) {
+		output << " {";
+		output.write(choices.data(), choices.size());
+		output << '}';
+	}
+
+	output << '\n';
 }
 
 
@@ -86,6 +94,13 @@ HelpFormatter::operator() (std::ostream& output,
 						   StringView progname,
                            Parser::Command const& cmd
                            ) {
+	if (cmd.isLazy()) {  // Help of a command lists its options, so it has to be built
+		auto maybeCommand = cmd.resolve();
+		if (maybeCommand) {
+			return (*this)(output, progname, *maybeCommand.unwrap());
+		}
+	}
+
 	output << "Usage: " << progname;  // Path::parse(c.argv[0]).getBasename();
 
     if (!cmd.options().empty()) {
@@ -134,39 +149,56 @@ VersionPrinter::operator() (std::ostream& output) {
 
 Parser::Option
 Parser::printVersion(StringView appName, Version const& appVersion) {
-    return {{"v", "version"}, "Print version", Parser::ArgumentValue::NotRequired,
-            [appName, &appVersion] (Optional<StringView> const&, Context const&) -> Optional<Error> {
-				VersionPrinter{appName, appVersion}
+	auto option = Option{{"v", "version"}, "Print version", Parser::ArgumentValue::NotRequired,
+            [appName, &appVersion] (Optional<StringView> const&, Context const& cntx) -> Optional<Error> {
+				auto const applet = cntx.parser.appletName(cntx.argv);
+				VersionPrinter{applet.empty() ? appName : applet, appVersion}
                     (std::cout);
 
 				return makeParserError(ParserError::NoError, "version");
 			}};
+
+	// Printing is a side effect that can not be replayed from a parse cache
+	option.cacheable(false);
+	option.preScanned(true);
+
+	return option;
 }
 
 
 Parser::Option
 Parser::Parser::printHelp() {
-	return {{"h", "help"}, "Print help", Parser::ArgumentValue::Optional,
+	auto option = Option{{"h", "help"}, "Print help", Parser::ArgumentValue::Optional,
 			[](Optional<StringView> const& value, Context const& cntx) -> Optional<Error> {
 				auto printer = HelpFormatter{cntx.parser.optionPrefix()};
 
+				auto const& command = cntx.currentCommand();
 				if (value) {
-					auto const& cmdIt = cntx.parser.commands().find(value.get());
-					if (cmdIt == cntx.parser.commands().end()) {
+					auto const& cmdIt = command.commands().find(value.get());
+					if (cmdIt == command.commands().end()) {
 						return makeError(BasicError::InvalidInput, "help");
 					}
 
+					auto maybeCommand = cmdIt->second.resolve();
+					if (!maybeCommand) {
+						return maybeCommand.moveError();
+					}
+
 					printer(std::cout,
 							cmdIt->first,
-							cmdIt->second);
+							*maybeCommand.unwrap());
                 } else {
 					printer(std::cout,
 							cntx.argv[0],
-							cntx.parser.defaultAction());
+							command);
 				}
 
 				return makeParserError(ParserError::NoError, "help");
 			}};
+	option.cacheable(false);
+	option.preScanned(true);
+
+	return option;
 }
 
 
@@ -0,0 +1,77 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/lazyCommand.cpp
+ *
+*******************************************************************************/
+
+#include "clime/parser.hpp"
+
+#include <mutex>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+struct Parser::Command::LazyBody {
+	Factory					factory;
+	std::once_flag			built;
+	std::unique_ptr<Command>	command;
+	Optional<Error>			error;
+
+	explicit LazyBody(Factory f)
+		: factory{mv(f)}
+	{}
+};
+
+
+Parser::Command
+Parser::Command::lazyCommand(StringView description, Factory factory) {
+	auto command = Command{description, Action{}};
+	command._lazy = std::make_shared<LazyBody>(mv(factory));
+
+	return command;
+}
+
+
+Result<Parser::Command const*, Error>
+Parser::Command::resolve() const {
+	if (!_lazy) {
+		return Ok(this);
+	}
+
+	auto& body = *_lazy;
+	std::call_once(body.built, [this, &body]() {
+		auto maybeCommand = body.factory();
+		body.factory = nullptr;  // Release resources captured by the factory
+		if (!maybeCommand) {
+			body.error = maybeCommand.moveError();
+			return;
+		}
+
+		body.command = std::make_unique<Command>(mv(maybeCommand.unwrap()));
+		if (body.command->description().empty()) {
+			body.command->description(_description);
+		}
+	});
+
+	if (body.error) {
+		return body.error.get();
+	}
+
+	return body.command->resolve();
+}
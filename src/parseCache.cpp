@@ -0,0 +1,372 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/parseCache.cpp
+ *
+*******************************************************************************/
+
+#include "clime/parseCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace /* anonymous */ {
+
+constexpr uint64 kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64 kFnvPrime = 1099511628211ULL;
+
+
+/// FNV-1a hash of argv tokens, including terminating NULs, and the parsing pass.
+uint64
+hashOf(ArrayView<const char*> args, Parser::Pass pass) noexcept {
+	uint64 hash = kFnvOffsetBasis;
+	hash = (hash ^ static_cast<uint64>(pass)) * kFnvPrime;
+
+	for (auto token : args) {
+		do {
+			hash = (hash ^ static_cast<unsigned char>(*token)) * kFnvPrime;
+		} while (*token++);
+	}
+
+	return hash;
+}
+
+
+/// Check if NUL-delimited key holds exactly the given tokens.
+bool
+isSameKey(std::string const& key, ArrayView<const char*> args) noexcept {
+	std::string::size_type offset = 0;
+	for (auto token : args) {
+		auto const length = std::strlen(token) + 1;  // Including terminating NUL
+		if (key.size() - offset < length || std::memcmp(key.data() + offset, token, length) != 0) {
+			return false;
+		}
+
+		offset += length;
+	}
+
+	return offset == key.size();
+}
+
+
+std::string
+makeKey(ArrayView<const char*> args) {
+	std::string key;
+	for (auto token : args) {
+		key.append(token, std::strlen(token) + 1);
+	}
+
+	return key;
+}
+
+
+StringView
+viewOf(Parser::Context::ArgVector const& argv, ParseTrace::Location const& location) noexcept {
+	return {argv[location.token] + location.offset, location.length};
+}
+
+}  // anonymous namespace
+
+
+
+void
+ParseTrace::storeBytes(void* dest, void const* value, size_t size) noexcept {
+	Step step{};
+	step.kind = Step::Kind::Store;
+	step.size = static_cast<uint8>(size);
+	step.value.token = kNoToken;
+	step.name.token = kNoToken;
+	step.dest = dest;
+	std::memcpy(&step.bits, value, size);
+
+	_steps.push_back(step);
+}
+
+
+bool
+ParseTrace::locate(StringView value, Parser::Context const& cntx, Location& location) const noexcept {
+	// Value is either a part of the current token or the next one
+	auto const end = std::min<Parser::Context::size_type>(cntx.offset + 2, cntx.argv.size());
+	for (auto i = cntx.offset; i < end; ++i) {
+		auto const token = StringView{cntx.argv[i]};
+		if (value.data() >= token.data() && value.data() + value.size() <= token.data() + token.size()) {
+			location.token = i;
+			location.offset = static_cast<size_type>(value.data() - token.data());
+			location.length = value.size();
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void
+ParseTrace::storeView(StringView* dest, StringView value, Parser::Context const& cntx) {
+	Step step{};
+	step.kind = Step::Kind::StoreView;
+	step.contextOffset = cntx.offset;
+	step.name.token = kNoToken;
+	step.dest = dest;
+	if (!locate(value, cntx, step.value)) {  // Value does not come from argv, can't be replayed
+		invalidate();
+		return;
+	}
+
+	_steps.push_back(step);
+}
+
+
+void
+ParseTrace::optionApplied(Parser::Option const& option, size_type mark,
+						  Optional<StringView> const& value, Parser::Context const& cntx) {
+	if (!option.isCacheable()) {
+		invalidate();
+		return;
+	}
+
+	Step step{};
+	step.kind = Step::Kind::OptionCall;
+	step.contextOffset = cntx.offset;
+	step.value.token = kNoToken;
+	step.name.token = kNoToken;
+	step.option = &option;
+	bool const isLocated = (!value || locate(*value, cntx, step.value)) && locate(cntx.name, cntx, step.name);
+
+	if (size() != mark) {  // Value bound by the option has been recorded already, only mark the option as applied
+		step.kind = Step::Kind::OptionMark;
+		if (!isLocated) {
+			step.value.token = kNoToken;
+			step.name.token = kNoToken;
+		}
+	} else if (!isLocated) {
+		invalidate();
+		return;
+	}
+
+	_steps.push_back(step);
+}
+
+
+void
+ParseTrace::argumentApplied(Parser::Argument const& argument, size_type mark,
+							StringView value, Parser::Context const& cntx) {
+	Step step{};
+	step.kind = (size() != mark)  // Value bound by the argument has been recorded already
+			? Step::Kind::ArgumentMark
+			: Step::Kind::ArgumentCall;
+	step.contextOffset = cntx.offset;
+	step.name.token = kNoToken;
+	step.argument = &argument;
+	if (!locate(value, cntx, step.value)) {
+		if (step.kind == Step::Kind::ArgumentCall) {
+			invalidate();
+			return;
+		}
+
+		step.value.token = kNoToken;
+	}
+
+	_steps.push_back(step);
+}
+
+
+void
+ParseTrace::commandSelected(Location name) {
+	Step step{};
+	step.kind = Step::Kind::CommandMark;
+	step.value.token = kNoToken;
+	step.name = name;
+	step.dest = nullptr;
+
+	_steps.push_back(step);
+}
+
+
+void
+ParseTrace::clear() noexcept {
+	_steps.clear();
+	_command = nullptr;
+	_replayable = true;
+}
+
+
+Result<Parser::ParseResult, Error>
+ParseTrace::replay(Parser::Context const& cntx) const {
+	if (!isReplayable()) {
+		return makeParserError(ParserError::InvalidInput, "trace");
+	}
+
+	for (auto const& step : _steps) {
+		switch (step.kind) {
+		case Step::Kind::Store:
+			std::memcpy(step.dest, &step.bits, step.size);
+			break;
+
+		case Step::Kind::StoreView:
+			*static_cast<StringView*>(step.dest) = cntx.retain(viewOf(cntx.argv, step.value));
+			break;
+
+		case Step::Kind::OptionCall: {
+			auto const value = (step.value.token == kNoToken)
+					? Optional<StringView>{}
+					: Optional<StringView>{viewOf(cntx.argv, step.value)};
+			auto maybeError = step.option->match(value,
+												 cntx.withOffsetAndName(step.contextOffset,
+																		viewOf(cntx.argv, step.name)));
+			if (maybeError) {
+				return maybeError.move();
+			}
+		} break;
+
+		case Step::Kind::ArgumentCall: {
+			auto maybeError = step.argument->match(viewOf(cntx.argv, step.value),
+												   cntx.withOffsetAndName(step.contextOffset,
+																		  step.argument->name()));
+			if (maybeError) {
+				return maybeError.move();
+			}
+		} break;
+
+		case Step::Kind::OptionMark:
+		case Step::Kind::ArgumentMark:
+		case Step::Kind::CommandMark:
+			break;
+		}
+	}
+
+	return Ok(_command->action());
+}
+
+
+
+Result<Parser::ParseResult, Error>
+ParseCache::parse(ArrayView<const char*> args, Parser::Pass pass) {
+	return parse(args, pass, nullptr);
+}
+
+
+Result<Parser::ParseResult, Error>
+ParseCache::parse(ArrayView<const char*> args, StringArena& arena, Parser::Pass pass) {
+	return parse(args, pass, &arena);
+}
+
+
+Result<Parser::ParseResult, Error>
+ParseCache::parse(ArrayView<const char*> args, Parser::Pass pass, StringArena* arena) {
+	Entry entry{0, pass, {}, {}};
+
+	// Empty and malformed command lines are not worth caching
+	bool const isCacheable = !args.empty() && std::all_of(args.begin(), args.end(), [](auto token) { return token != nullptr; });
+	if (!isCacheable) {
+		_stats.uncacheable += 1;
+		return _parser.parse(args, entry.trace, arena, pass);
+	}
+
+	entry.hash = hashOf(args, pass);
+	auto const indexIt = _index.find(entry.hash);
+	if (indexIt != _index.end() &&
+		indexIt->second->pass == pass &&
+		isSameKey(indexIt->second->key, args)) {
+		_stats.hits += 1;
+
+		// Mark entry as the most recently used
+		_entries.splice(_entries.begin(), _entries, indexIt->second);
+
+		StringArena::ParseScope const scope{arena};
+
+		// Note: Deferred options are not cacheable, but argument callbacks may still defer work
+		std::vector<Parser::DeferredTask> deferred;
+		auto result = _entries.front().trace.replay({args, 1, args[0], _parser, pass, arena, nullptr, &deferred});
+		if (result) {
+			auto maybeError = _parser.runDeferred(deferred);
+			if (maybeError) {
+				result = maybeError.move();
+			}
+		}
+
+		return result;
+	}
+
+	_stats.misses += 1;
+	auto result = _parser.parse(args, entry.trace, arena, pass);
+	if (!result || !entry.trace.isReplayable()) {
+		_stats.uncacheable += 1;
+		return result;
+	}
+
+	entry.key = makeKey(args);
+	insert(mv(entry));
+
+	return result;
+}
+
+
+void
+ParseCache::insert(Entry&& entry) {
+	auto const entryMemory = entry.memoryUsed();
+	if (_maxEntries == 0 || entryMemory > _maxMemory) {
+		_stats.uncacheable += 1;
+		return;
+	}
+
+	// Hash collision: the new command line replaces the old one
+	auto const indexIt = _index.find(entry.hash);
+	if (indexIt != _index.end()) {
+		_stats.memoryUsed -= indexIt->second->memoryUsed();
+		_stats.entries -= 1;
+		_stats.evictions += 1;
+		_entries.erase(indexIt->second);
+		_index.erase(indexIt);
+	}
+
+	while (!_entries.empty() &&
+		   (_stats.entries + 1 > _maxEntries || _stats.memoryUsed + entryMemory > _maxMemory)) {
+		evictLast();
+	}
+
+	_entries.push_front(mv(entry));
+	_index.emplace(_entries.front().hash, _entries.begin());
+	_stats.entries += 1;
+	_stats.memoryUsed += entryMemory;
+}
+
+
+void
+ParseCache::evictLast() noexcept {
+	auto& last = _entries.back();
+	_stats.memoryUsed -= last.memoryUsed();
+	_stats.entries -= 1;
+	_stats.evictions += 1;
+
+	_index.erase(last.hash);
+	_entries.pop_back();
+}
+
+
+void
+ParseCache::clear() noexcept {
+	_index.clear();
+	_entries.clear();
+	_stats.entries = 0;
+	_stats.memoryUsed = 0;
+}
@@ -0,0 +1,405 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/parseSnapshot.cpp
+ *
+*******************************************************************************/
+
+#include "clime/parseSnapshot.hpp"
+
+#include <cstring>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace /* anonymous */ {
+
+using Location = ParseTrace::Location;
+using Step = ParseTrace::Step;
+
+constexpr uint64 kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64 kFnvPrime = 1099511628211ULL;
+
+
+/// Snapshot layout: header, path of sub-command names, records, NUL-terminated argv tokens.
+struct Header {
+	uint32	magic;
+	uint16	version;
+	uint16	flags;
+	uint64	fingerprint;
+	uint32	nbTokens;
+	uint32	nbPath;
+	uint32	nbRecords;
+	uint32	tokensSize;
+};
+
+/// Option or argument applied by the parse.
+struct Record {
+	enum Kind : uint8 {
+		Option,
+		Argument
+	};
+
+	uint8		kind;
+
+	/// Index of the command in the path, 0 is the top level command.
+	uint8		depth;
+	uint16		reserved;
+
+	/// Index of the option or argument in its command.
+	uint32		index;
+	uint32		contextOffset;
+	Location	name;
+	Location	value;
+};
+
+static_assert(sizeof(Header) == 32, "Snapshot header must have no padding");
+static_assert(sizeof(Location) == 12, "Snapshot location must have no padding");
+static_assert(sizeof(Record) == 36, "Snapshot record must have no padding");
+
+
+uint64
+hashBytes(uint64 hash, void const* data, size_t size) noexcept {
+	auto const bytes = static_cast<unsigned char const*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * kFnvPrime;
+	}
+
+	return hash;
+}
+
+
+uint64
+hashString(uint64 hash, StringView value) noexcept {
+	auto const size = static_cast<uint32>(value.size());
+	hash = hashBytes(hash, &size, sizeof(size));
+
+	return hashBytes(hash, value.data(), value.size());
+}
+
+
+uint64
+hashNumber(uint64 hash, uint32 value) noexcept {
+	return hashBytes(hash, &value, sizeof(value));
+}
+
+
+StringView
+viewOf(ArrayView<const char*> argv, Location const& location) noexcept {
+	return {argv[location.token] + location.offset, location.length};
+}
+
+
+/// Find an element by its address in one of the vectors of the commands on the path, searching the last first.
+template<typename T, typename Get>
+bool
+findInPath(std::vector<Parser::Command const*> const& path, T const* element, Get&& get, Record& record) noexcept {
+	for (auto depth = path.size(); depth > 0; --depth) {
+		auto const& elements = get(*path[depth - 1]);
+		if (!elements.empty() && element >= elements.data() && element < elements.data() + elements.size()) {
+			record.depth = static_cast<uint8>(depth - 1);
+			record.index = static_cast<uint32>(element - elements.data());
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+template<typename T>
+void
+append(std::string& data, T const& value) {
+	data.append(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+
+template<typename T>
+T
+read(StringView snapshot, size_t offset) noexcept {
+	T value;
+	std::memcpy(&value, snapshot.data() + offset, sizeof(value));
+
+	return value;
+}
+
+
+Error
+malformedSnapshot() noexcept {
+	return makeParserError(ParserError::InvalidInput, "snapshot");
+}
+
+}  // anonymous namespace
+
+
+uint64
+ParseSnapshot::fingerprint(ArrayView<Parser::Command const*> path) noexcept {
+	uint64 hash = kFnvOffsetBasis;
+
+	for (auto command : path) {
+		hash = hashNumber(hash, static_cast<uint32>(command->options().size()));
+		for (auto const& option : command->options()) {
+			hash = hashNumber(hash, static_cast<uint32>(option.names().size()));
+			for (auto const& name : option.names()) {
+				hash = hashString(hash, name);
+			}
+
+			hash = hashNumber(hash, static_cast<uint32>(option.argumentExpectations()));
+			hash = hashString(hash, option.choices());
+		}
+
+		hash = hashNumber(hash, static_cast<uint32>(command->arguments().size()));
+		for (auto const& argument : command->arguments()) {
+			hash = hashString(hash, argument.name());
+		}
+	}
+
+	return hash;
+}
+
+
+Result<ParseSnapshot, Error>
+ParseSnapshot::capture(Parser const& parser, ArrayView<const char*> args, ParseTrace const& trace) {
+	if (!trace.isReplayable()) {
+		return makeParserError(ParserError::InvalidInput, "trace");
+	}
+
+	std::vector<Parser::Command const*> path{&parser.defaultAction()};
+	std::vector<Location> names;
+	std::vector<Record> records;
+
+	auto isValid = [&args](Location const& location) {
+		return location.token < args.size() &&
+				location.offset + location.length <= std::strlen(args[location.token]);
+	};
+
+	for (auto const& step : trace.steps()) {
+		Record record{};
+		record.contextOffset = step.contextOffset;
+		record.name = step.name;
+		record.value = step.value;
+
+		switch (step.kind) {
+		case Step::Kind::CommandMark: {
+			if (!isValid(step.name) || path.size() > 0xFF) {
+				return malformedSnapshot();
+			}
+
+			auto const& commands = path.back()->commands();
+			auto const cmdIt = commands.find(viewOf(args, step.name));
+			if (cmdIt == commands.end()) {
+				return malformedSnapshot();
+			}
+
+			auto maybeCommand = cmdIt->second.resolve();
+			if (!maybeCommand) {
+				return maybeCommand.moveError();
+			}
+
+			path.push_back(maybeCommand.unwrap());
+			names.push_back(step.name);
+		} continue;
+
+		case Step::Kind::OptionCall:
+		case Step::Kind::OptionMark:
+			record.kind = Record::Option;
+			if (!isValid(step.name) ||
+				(step.value.token != ParseTrace::kNoToken && !isValid(step.value)) ||
+				!findInPath(path, step.option, [](auto const& command) -> auto const& { return command.options(); },
+							record)) {
+				return malformedSnapshot();
+			}
+			break;
+
+		case Step::Kind::ArgumentCall:
+		case Step::Kind::ArgumentMark:
+			record.kind = Record::Argument;
+			if (!isValid(step.value) ||
+				!findInPath(path, step.argument, [](auto const& command) -> auto const& { return command.arguments(); },
+							record)) {
+				return malformedSnapshot();
+			}
+			break;
+
+		default:  // Values stored by the callbacks are reproduced by calling them again
+			continue;
+		}
+
+		records.push_back(record);
+	}
+
+	if (path.back() != trace.command()) {
+		return malformedSnapshot();
+	}
+
+	uint32 tokensSize = 0;
+	for (auto token : args) {
+		tokensSize += static_cast<uint32>(std::strlen(token) + 1);
+	}
+
+	Header header{};
+	header.magic = kMagic;
+	header.version = kVersion;
+	header.fingerprint = fingerprint(arrayView(path.data(), path.size()));
+	header.nbTokens = args.size();
+	header.nbPath = static_cast<uint32>(names.size());
+	header.nbRecords = static_cast<uint32>(records.size());
+	header.tokensSize = tokensSize;
+
+	ParseSnapshot snapshot;
+	snapshot._data.reserve(sizeof(Header) + names.size() * sizeof(Location) + records.size() * sizeof(Record) +
+						   tokensSize);
+	append(snapshot._data, header);
+	for (auto const& name : names) {
+		append(snapshot._data, name);
+	}
+
+	for (auto const& record : records) {
+		append(snapshot._data, record);
+	}
+
+	for (auto token : args) {
+		snapshot._data.append(token, std::strlen(token) + 1);  // Including terminating NUL
+	}
+
+	return Ok(mv(snapshot));
+}
+
+
+Result<Parser::ParseResult, Error>
+ParseSnapshot::rebind(Parser const& parser, StringView snapshot, StringArena* arena) {
+	if (snapshot.size() < sizeof(Header)) {
+		return malformedSnapshot();
+	}
+
+	auto const header = read<Header>(snapshot, 0);
+	if (header.magic != kMagic) {
+		return malformedSnapshot();
+	}
+
+	if (header.version != kVersion) {
+		return makeParserError(ParserError::InvalidInput, "snapshot version");
+	}
+
+	size_t const pathOffset = sizeof(Header);
+	size_t const recordsOffset = pathOffset + size_t{header.nbPath} * sizeof(Location);
+	size_t const tokensOffset = recordsOffset + size_t{header.nbRecords} * sizeof(Record);
+	if (snapshot.size() != tokensOffset + header.tokensSize || header.nbPath >= 0xFF) {
+		return malformedSnapshot();
+	}
+
+	// Tokens are NUL-terminated strings in the snapshot itself
+	std::vector<char const*> tokens;
+	std::vector<uint32> tokenSizes;
+	tokens.reserve(header.nbTokens);
+	tokenSizes.reserve(header.nbTokens);
+	for (auto offset = tokensOffset; offset < snapshot.size(); ) {
+		auto const token = snapshot.data() + offset;
+		auto const end = static_cast<char const*>(std::memchr(token, 0, snapshot.size() - offset));
+		if (!end) {
+			return malformedSnapshot();
+		}
+
+		tokens.push_back(token);
+		tokenSizes.push_back(static_cast<uint32>(end - token));
+		offset += tokenSizes.back() + 1;
+	}
+
+	if (tokens.size() != header.nbTokens) {
+		return malformedSnapshot();
+	}
+
+	auto const argv = arrayView(tokens.data(), tokens.size());
+	auto isValid = [&tokenSizes](Location const& location) {
+		return location.token < tokenSizes.size() &&
+				location.length <= tokenSizes[location.token] &&
+				location.offset <= tokenSizes[location.token] - location.length;
+	};
+
+	std::vector<Parser::Command const*> path{&parser.defaultAction()};
+	path.reserve(header.nbPath + 1);
+	for (uint32 i = 0; i < header.nbPath; ++i) {
+		auto const name = read<Location>(snapshot, pathOffset + i * sizeof(Location));
+		if (!isValid(name)) {
+			return malformedSnapshot();
+		}
+
+		auto const& commands = path.back()->commands();
+		auto const cmdIt = commands.find(viewOf(argv, name));
+		if (cmdIt == commands.end()) {
+			return makeParserError(ParserError::InvalidInput, "snapshot schema");
+		}
+
+		auto maybeCommand = cmdIt->second.resolve();
+		if (!maybeCommand) {
+			return maybeCommand.moveError();
+		}
+
+		path.push_back(maybeCommand.unwrap());
+	}
+
+	if (header.fingerprint != fingerprint(arrayView(path.data(), path.size()))) {
+		return makeParserError(ParserError::InvalidInput, "snapshot schema");
+	}
+
+	std::vector<Parser::DeferredTask> deferred;
+	for (uint32 i = 0; i < header.nbRecords; ++i) {
+		auto const record = read<Record>(snapshot, recordsOffset + i * sizeof(Record));
+		if (record.depth >= path.size() || record.contextOffset >= argv.size()) {
+			return malformedSnapshot();
+		}
+
+		auto const command = path[record.depth];
+		Optional<Error> maybeError;
+		if (record.kind == Record::Option && record.index < command->options().size() && isValid(record.name)) {
+			auto const& option = command->options()[record.index];
+			Optional<StringView> value;
+			if (record.value.token != ParseTrace::kNoToken) {
+				if (!isValid(record.value)) {
+					return malformedSnapshot();
+				}
+
+				value = viewOf(argv, record.value);
+			}
+
+			maybeError = option.match(value, Parser::Context{argv, record.contextOffset, viewOf(argv, record.name),
+															 parser, Parser::Pass::Startup, arena, nullptr, &deferred,
+															 command});
+		} else if (record.kind == Record::Argument && record.index < command->arguments().size() &&
+				   isValid(record.value)) {
+			auto const& argument = command->arguments()[record.index];
+			maybeError = argument.match(viewOf(argv, record.value),
+										Parser::Context{argv, record.contextOffset, argument.name(),
+														parser, Parser::Pass::Startup, arena, nullptr, &deferred,
+														command});
+		} else {
+			return malformedSnapshot();
+		}
+
+		if (maybeError) {
+			return maybeError.move();
+		}
+	}
+
+	auto maybeError = parser.runDeferred(deferred);
+	if (maybeError) {
+		return maybeError.move();
+	}
+
+	return Ok(path.back()->action());
+}
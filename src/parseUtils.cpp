@@ -101,6 +101,220 @@ struct Longest<T, false> {
 };
 
 
+
+/// Unit suffix of a scaled value and its size in base units.
+struct Unit {
+	StringLiteral	suffix;
+	uint64			scale;
+};
+
+
+constexpr uint64 kNanosPerSecond = 1000000000ULL;
+
+constexpr Unit kDurationUnits[] = {
+	{"ns", 1},
+	{"us", 1000ULL},
+	{"ms", 1000000ULL},
+	{"s", kNanosPerSecond},
+	{"m", 60 * kNanosPerSecond},
+	{"h", 3600 * kNanosPerSecond},
+	{"d", 86400 * kNanosPerSecond}
+};
+
+constexpr Unit kByteUnits[] = {
+	{"", 1},
+	{"B", 1},
+	{"kB", 1000ULL},
+	{"KB", 1000ULL},
+	{"MB", 1000ULL * 1000},
+	{"GB", 1000ULL * 1000 * 1000},
+	{"TB", 1000ULL * 1000 * 1000 * 1000},
+	{"PB", 1000ULL * 1000 * 1000 * 1000 * 1000},
+	{"EB", 1000ULL * 1000 * 1000 * 1000 * 1000 * 1000},
+	{"K", 1ULL << 10},
+	{"M", 1ULL << 20},
+	{"G", 1ULL << 30},
+	{"T", 1ULL << 40},
+	{"P", 1ULL << 50},
+	{"E", 1ULL << 60},
+	{"KiB", 1ULL << 10},
+	{"MiB", 1ULL << 20},
+	{"GiB", 1ULL << 30},
+	{"TiB", 1ULL << 40},
+	{"PiB", 1ULL << 50},
+	{"EiB", 1ULL << 60}
+};
+
+/// Maximum number of significant fractional digits of a scaled value.
+constexpr StringView::size_type kMaxFractionDigits = 9;
+
+constexpr uint64 kPowersOf10[kMaxFractionDigits + 1] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+};
+
+
+bool isDigit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+bool isLetter(char c) noexcept { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+
+/// Compute a * b, return false if the result does not fit into uint64.
+bool checkedMul(uint64 a, uint64 b, uint64& result) noexcept {
+	if (b != 0 && a > std::numeric_limits<uint64>::max() / b) {
+		return false;
+	}
+
+	result = a * b;
+	return true;
+}
+
+/// Compute a + b, return false if the result does not fit into uint64.
+bool checkedAdd(uint64 a, uint64 b, uint64& result) noexcept {
+	if (a > std::numeric_limits<uint64>::max() - b) {
+		return false;
+	}
+
+	result = a + b;
+	return true;
+}
+
+
+/**
+ * Parse a decimal number with an optional fractional part followed by a unit suffix from the table.
+ * @param value String to parse.
+ * @param pos Position to start parsing at, advanced past the unit suffix on success.
+ * @param units Table of valid unit suffixes.
+ * @return The number in base units.
+ */
+template<size_t N>
+Result<uint64, Error>
+parseScaled(StringView value, StringView::size_type& pos, Unit const (&units)[N]) noexcept {
+	auto const start = pos;
+	uint64 whole = 0;
+	while (pos < value.size() && isDigit(value[pos])) {
+		if (!checkedMul(whole, 10, whole) || !checkedAdd(whole, static_cast<uint64>(value[pos] - '0'), whole)) {
+			return conversionError("Value is outside of uint64 range", value);
+		}
+		++pos;
+	}
+
+	if (pos == start) {
+		return conversionError("Not a valid number", value);
+	}
+
+	uint64 fraction = 0;
+	StringView::size_type fractionDigits = 0;
+	if (pos < value.size() && value[pos] == '.') {
+		auto const fractionStart = ++pos;
+		auto significantEnd = pos;
+		while (pos < value.size() && isDigit(value[pos])) {
+			if (value[pos] != '0') {
+				significantEnd = pos + 1;
+			}
+			++pos;
+		}
+
+		if (pos == fractionStart) {
+			return conversionError("Not a valid number", value);
+		}
+
+		fractionDigits = significantEnd - fractionStart;
+		if (fractionDigits > kMaxFractionDigits) {
+			return conversionError("Value is too precise", value);
+		}
+
+		for (auto i = fractionStart; i < significantEnd; ++i) {
+			fraction = fraction * 10 + static_cast<uint64>(value[i] - '0');
+		}
+	}
+
+	auto const suffixStart = pos;
+	while (pos < value.size() && isLetter(value[pos])) {
+		++pos;
+	}
+
+	auto const suffix = StringView{value.data() + suffixStart, pos - suffixStart};
+	Unit const* unit = nullptr;
+	for (auto const& candidate : units) {
+		if (candidate.suffix.equals(suffix)) {
+			unit = &candidate;
+			break;
+		}
+	}
+
+	if (!unit) {
+		return conversionError("Unknown unit", value);
+	}
+
+	// Fractional part of the value is: fraction * (q * 10^k + r) / 10^k = fraction * q + fraction * r / 10^k
+	// Where fraction < 10^k and r < 10^k, so fraction * r can't overflow.
+	auto const denominator = kPowersOf10[fractionDigits];
+	auto const q = unit->scale / denominator;
+	auto const r = unit->scale % denominator;
+	if ((fraction * r) % denominator != 0) {
+		return conversionError("Value is not a whole number of base units", value);
+	}
+
+	uint64 result = 0;
+	uint64 fractionalPart = 0;
+	if (!checkedMul(whole, unit->scale, result) ||
+		!checkedMul(fraction, q, fractionalPart) ||
+		!checkedAdd(result, fractionalPart, result) ||
+		!checkedAdd(result, fraction * r / denominator, result)) {
+		return conversionError("Value is outside of uint64 range", value);
+	}
+
+	return Ok(result);
+}
+
+
+/// Parse exactly given number of decimal digits.
+bool parseDigits(StringView value, StringView::size_type& pos, StringView::size_type width, uint32& result) noexcept {
+	if (value.size() - pos < width) {
+		return false;
+	}
+
+	result = 0;
+	for (auto const end = pos + width; pos < end; ++pos) {
+		if (!isDigit(value[pos])) {
+			return false;
+		}
+
+		result = result * 10 + static_cast<uint32>(value[pos] - '0');
+	}
+
+	return true;
+}
+
+bool expectChar(StringView value, StringView::size_type& pos, char c) noexcept {
+	if (pos >= value.size() || value[pos] != c) {
+		return false;
+	}
+
+	++pos;
+	return true;
+}
+
+bool isLeapYear(uint32 year) noexcept {
+	return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+uint32 daysInMonth(uint32 year, uint32 month) noexcept {
+	constexpr uint32 kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	return (month == 2 && isLeapYear(year)) ? 29 : kDays[month - 1];
+}
+
+/// Number of days since 1970-01-01 of a date in proleptic Gregorian calendar.
+int64 daysFromCivil(uint32 year, uint32 month, uint32 day) noexcept {
+	auto const y = static_cast<int64>(year) - (month <= 2 ? 1 : 0);
+	auto const era = (y >= 0 ? y : y - 399) / 400;
+	auto const yearOfEra = y - era * 400;
+	auto const dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	auto const dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+	return era * 146097 + dayOfEra - 719468;
+}
+
 }  // namespace
 
 
@@ -142,3 +356,152 @@ clime::tryParseUInt32(StringView value) noexcept { return Longest<uint32>::parse
 
 Result<uint64, Error>
 clime::tryParseUInt64(StringView value) noexcept { return Longest<uint64>::parse(value); }
+
+Result<float32, Error>
+clime::tryParseFloat32(StringView value) noexcept {
+	char* pEnd = nullptr;
+	// FIXME(abbyssoul): The use of value.data() here is not safe for substrings.
+	auto const result = strtof(value.data(), &pEnd);
+	if (!pEnd || pEnd == value.data()) {  // No conversion has been done
+		return conversionError("Not a valid float32", value);
+	}
+
+	return Ok(result);
+}
+
+Result<float64, Error>
+clime::tryParseFloat64(StringView value) noexcept {
+	char* pEnd = nullptr;
+	// FIXME(abbyssoul): The use of value.data() here is not safe for substrings.
+	auto const result = strtod(value.data(), &pEnd);
+	if (!pEnd || pEnd == value.data()) {  // No conversion has been done
+		return conversionError("Not a valid float64", value);
+	}
+
+	return Ok(result);
+}
+
+
+
+Result<std::chrono::nanoseconds, Error>
+clime::tryParseDuration(StringView value) noexcept {
+	if (value.equals("0")) {
+		return Ok(std::chrono::nanoseconds{0});
+	}
+
+	if (value.empty()) {
+		return conversionError("Not a valid duration", value);
+	}
+
+	uint64 total = 0;
+	StringView::size_type pos = 0;
+	while (pos < value.size()) {
+		auto component = parseScaled(value, pos, kDurationUnits);
+		if (!component) {
+			return component.moveError();
+		}
+
+		if (!checkedAdd(total, component.unwrap(), total)) {
+			return conversionError("Duration is out of range", value);
+		}
+	}
+
+	if (total > static_cast<uint64>(std::numeric_limits<std::chrono::nanoseconds::rep>::max())) {
+		return conversionError("Duration is out of range", value);
+	}
+
+	return Ok(std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(total)});
+}
+
+
+Result<ByteSize, Error>
+clime::tryParseByteSize(StringView value) noexcept {
+	StringView::size_type pos = 0;
+	auto bytes = parseScaled(value, pos, kByteUnits);
+	if (!bytes) {
+		return bytes.moveError();
+	}
+
+	if (pos != value.size()) {
+		return conversionError("Not a valid size", value);
+	}
+
+	return Ok(ByteSize{bytes.unwrap()});
+}
+
+
+Result<UtcTimestamp, Error>
+clime::tryParseTimestamp(StringView value) noexcept {
+	StringView::size_type pos = 0;
+	uint32 year = 0, month = 0, day = 0;
+	if (!parseDigits(value, pos, 4, year) || !expectChar(value, pos, '-') ||
+		!parseDigits(value, pos, 2, month) || !expectChar(value, pos, '-') ||
+		!parseDigits(value, pos, 2, day)) {
+		return conversionError("Not a valid date", value);
+	}
+
+	if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+		return conversionError("Not a valid date", value);
+	}
+
+	uint32 hour = 0, minute = 0, second = 0, nanos = 0;
+	int64 offset = 0;
+	if (pos < value.size()) {
+		auto const separator = value[pos++];
+		if ((separator != 'T' && separator != 't' && separator != ' ') ||
+			!parseDigits(value, pos, 2, hour) || !expectChar(value, pos, ':') ||
+			!parseDigits(value, pos, 2, minute) || !expectChar(value, pos, ':') ||
+			!parseDigits(value, pos, 2, second) ||
+			hour > 23 || minute > 59 || second > 59) {
+			return conversionError("Not a valid time", value);
+		}
+
+		if (expectChar(value, pos, '.')) {
+			auto const fractionStart = pos;
+			while (pos < value.size() && isDigit(value[pos])) {
+				++pos;
+			}
+
+			auto const digits = pos - fractionStart;
+			if (digits == 0 || digits > kMaxFractionDigits) {
+				return conversionError("Not a valid fraction of a second", value);
+			}
+
+			pos = fractionStart;
+			parseDigits(value, pos, digits, nanos);
+			nanos *= static_cast<uint32>(kPowersOf10[kMaxFractionDigits - digits]);
+		}
+
+		if (pos < value.size() && (value[pos] == 'Z' || value[pos] == 'z')) {
+			++pos;
+		} else if (pos < value.size() && (value[pos] == '+' || value[pos] == '-')) {
+			auto const sign = (value[pos++] == '-') ? -1 : 1;
+			uint32 offsetHours = 0, offsetMinutes = 0;
+			if (!parseDigits(value, pos, 2, offsetHours) || !expectChar(value, pos, ':') ||
+				!parseDigits(value, pos, 2, offsetMinutes) ||
+				offsetHours > 23 || offsetMinutes > 59) {
+				return conversionError("Not a valid time zone offset", value);
+			}
+
+			offset = sign * static_cast<int64>(offsetHours * 3600 + offsetMinutes * 60);
+		} else {
+			return conversionError("Time zone is expected", value);
+		}
+
+		if (pos != value.size()) {
+			return conversionError("Not a valid timestamp", value);
+		}
+	}
+
+	// Note: seconds can't overflow as the year is limited to 4 digits
+	auto const seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+	constexpr auto kMaxSeconds = std::numeric_limits<int64>::max() / static_cast<int64>(kNanosPerSecond);
+	constexpr auto kMinSeconds = std::numeric_limits<int64>::min() / static_cast<int64>(kNanosPerSecond);
+	if (seconds > kMaxSeconds || seconds < kMinSeconds ||
+		seconds * static_cast<int64>(kNanosPerSecond) > std::numeric_limits<int64>::max() - nanos) {
+		return conversionError("Timestamp is out of range", value);
+	}
+
+	auto const sinceEpoch = std::chrono::nanoseconds{seconds * static_cast<int64>(kNanosPerSecond) + nanos};
+	return Ok(UtcTimestamp{sinceEpoch});
+}
@@ -20,13 +20,21 @@
 *******************************************************************************/
 
 #include "clime/parser.hpp"
+#include "clime/parseCache.hpp"
+#include "clime/diagnostics.hpp"
 #include "clime/utils.hpp"
+#include "clime/threadPool.hpp"
 
 #include <solace/posixErrorDomain.hpp>
 #include <solace/output_utils.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 
 using namespace Solace;
@@ -78,10 +86,33 @@ parseOption(StringView arg, char prefix, char valueSeparator) noexcept {
 }
 
 
+/// Token of argv to report with an error, empty if the token is null.
+StringView
+tokenAt(Parser::Context::ArgVector const& argv, Parser::Context::size_type index) noexcept {
+	return argv[index] ? StringView{argv[index]} : StringView{};
+}
+
+
+/**
+ * Report an error of a tolerant parse, @see Parser::validate().
+ * @return True if parsing is to carry on past the error, false if the error is to be returned.
+ */
+bool
+tolerate(Parser::Context const& cntx, Error const& error) {
+	if (!cntx.diagnostics) {
+		return false;
+	}
+
+	cntx.diagnostics->report(error);
+	return true;
+}
+
+
 Result<uint32, Error>
 parseOptions(Parser::Context const& cntx,
              std::vector<Parser::Option> const& options,
-             char prefix, char separator) {
+             char prefix, char separator,
+			 Parser::Constraint::OptionMask& seen) {
     auto firstPositionalArgument = cntx.offset;
 
     // Parse array of strings until we error out or there is no more flags:
@@ -90,7 +121,12 @@ parseOptions(Parser::Context const& cntx,
 		 ++i, ++firstPositionalArgument) {
 
 		if (!cntx.argv[i]) {
-			return makeParserError(ParserError::InvalidInput, "null string as input");
+			auto error = makeParserError(ParserError::InvalidInput, i, {});
+			if (!tolerate(cntx, error)) {
+				return error;
+			}
+
+			continue;
         }
 
         auto const arg = StringView{cntx.argv[i]};
@@ -117,12 +153,19 @@ parseOptions(Parser::Context const& cntx,
 
         auto const optCntx = cntx.withOffsetAndName(i, argName);
 
-        for (auto& option : options) {
+        for (size_t index = 0; index < options.size(); ++index) {
+			auto const& option = options[index];
             if (option.isMatch(argName)) {
 				if (argValue.isNone() && Parser::ArgumentValue::Required == option.argumentExpectations()) {
                     // Argument is required but none was given, error out!
 					// Error message: "Option '{}' expects a value, but none were given", optCntx.name);
-					return makeParserError(ParserError::ValueExpected, "No value given");
+					auto error = makeParserError(ParserError::ValueExpected, i, arg);
+					if (!tolerate(cntx, error)) {
+						return error;
+					}
+
+					numberMatched += 1;
+					continue;
                 }
 
                 if (consumeValue &&
@@ -134,19 +177,51 @@ parseOptions(Parser::Context const& cntx,
                 }
 
                 numberMatched += 1;
-
-				auto r = option.match((Parser::ArgumentValue::NotRequired == option.argumentExpectations())
-									  ? none
-									  : argValue,
-									  optCntx);
+				if (index < Parser::Constraint::kMaxOptions) {
+					seen |= Parser::Constraint::OptionMask{1} << index;
+				}
+
+				if (Parser::Pass::Reload == cntx.pass && !option.isReloadable()) {
+					// Startup-only options keep values they had been given initially
+					continue;
+				}
+
+				if (cntx.diagnostics && !option.isCacheable()) {
+					// Validation must not have side effects, such as printing help
+					continue;
+				}
+
+				if (option.isPreScanned() && Parser::Pass::Startup == cntx.pass && !cntx.diagnostics &&
+					&options == &cntx.parser.defaultAction().options()) {
+					// Top-level option has already been handled by the pre-scan, @see preScanOptions()
+					continue;
+				}
+
+				auto const mark = cntx.trace ? cntx.trace->size() : 0;
+				auto const optionValue = (Parser::ArgumentValue::NotRequired == option.argumentExpectations())
+						? Optional<StringView>{}
+						: argValue;
+				auto r = option.match(optionValue, optCntx);
 				if (r.isSome()) {
-					return r.move();
+					if (!tolerate(cntx, r.get())) {
+						return r.move();
+					}
+
+					continue;
                 }
+
+				if (cntx.trace) {
+					cntx.trace->optionApplied(option, mark, optionValue, optCntx);
+				}
             }
         }
 
         if (numberMatched < 1) {
-			return makeParserError(ParserError::UnexpectedValue, "Unexpected option");
+			// Unknown option is skipped on its own: the next token can't be told apart from a positional value
+			auto error = makeParserError(ParserError::UnexpectedValue, i, argName);
+			if (!tolerate(cntx, error)) {
+				return error;
+			}
         }
     }
 
@@ -154,6 +229,100 @@ parseOptions(Parser::Context const& cntx,
 }
 
 
+Optional<Error>
+matchArgument(Parser::Argument const& argument, Parser::Context const& cntx, Parser::Context::size_type position) {
+	// Check that we didn't hit argv end:
+	if (!cntx.argv[position]) {
+		return makeParserError(ParserError::InvalidInput, position, {});
+	}
+
+	auto const subCntx = cntx.withOffsetAndName(position, argument.name());
+	auto const arg = StringView {cntx.argv[position]};
+	auto const mark = cntx.trace ? cntx.trace->size() : 0;
+	auto maybeError = argument.match(arg, subCntx);
+	if (maybeError) {
+		return maybeError;
+	}
+
+	if (cntx.trace) {
+		cntx.trace->argumentApplied(argument, mark, arg, subCntx);
+	}
+
+	return none;
+}
+
+
+/**
+ * Match all the remaining values to an independent trailing argument using multiple threads.
+ * Values are claimed by workers in argv order, so once a value has failed all the values before it
+ * have been claimed: the first error by position is reported regardless of scheduling.
+ * If the first failure is an exception thrown by the callback, it is rethrown in the calling thread.
+ */
+Optional<Error>
+matchIndependentArgument(Parser::Argument const& argument,
+						 Parser::Context const& cntx,
+						 Parser::Context::size_type first) {
+	using size_type = Parser::Context::size_type;
+
+	auto const end = cntx.argv.size();
+	auto nbThreads = cntx.parser.concurrencyLimit();
+	if (nbThreads == 0) {
+		nbThreads = std::max(1U, std::thread::hardware_concurrency());
+	}
+	nbThreads = std::min<size_type>(nbThreads, end - first);
+
+	// Note: Trace, arena and diagnostics are not thread-safe
+	if (nbThreads < 2 || cntx.trace || cntx.arena || cntx.diagnostics) {
+		for (auto position = first; position < end; ++position) {
+			auto maybeError = matchArgument(argument, cntx, position);
+			if (maybeError && !tolerate(cntx, maybeError.get())) {
+				return maybeError;
+			}
+		}
+
+		return none;
+	}
+
+	std::atomic<size_type> failedPosition{end};
+	std::mutex errorLock;
+	Optional<Error> firstError;
+	std::exception_ptr firstException;
+
+	forEachConcurrently(ThreadPool::shared(), end - first, nbThreads, [&](size_type index) {
+		auto const position = first + index;
+		if (position > failedPosition.load(std::memory_order_relaxed)) {
+			return false;
+		}
+
+		// Exceptions thrown by the callback are moved over to the calling thread
+		Optional<Error> maybeError;
+		std::exception_ptr exception;
+		try {
+			maybeError = matchArgument(argument, cntx, position);
+		} catch (...) {
+			exception = std::current_exception();
+		}
+
+		if (maybeError || exception) {
+			std::lock_guard<std::mutex> guard{errorLock};
+			if (position < failedPosition.load(std::memory_order_relaxed)) {
+				failedPosition.store(position, std::memory_order_relaxed);
+				firstError = mv(maybeError);
+				firstException = mv(exception);
+			}
+		}
+
+		return true;
+	});
+
+	if (firstException) {
+		std::rethrow_exception(firstException);
+	}
+
+	return firstError;
+}
+
+
 Result<uint32, Error>
 parseArguments(Parser::Context const& cntx,
                std::vector<Parser::Argument> const& arguments) {
@@ -163,33 +332,45 @@ parseArguments(Parser::Context const& cntx,
             : arguments.back().isTrailing();
 
     auto const nbPositionalArguments = cntx.argv.size() - cntx.offset;
+    auto end = cntx.argv.size();
 
     if (nbPositionalArguments < arguments.size() && !expectsTrailingArgument) {
-		return makeParserError(ParserError::InvalidNumberOfArgs, "Not enough arguments");
+		auto error = makeParserError(ParserError::InvalidNumberOfArgs, cntx.argv.size(), {});
+		if (!tolerate(cntx, error)) {
+			return error;
+		}
     }
 
     if (!expectsTrailingArgument && nbPositionalArguments > arguments.size()) {
-		return makeParserError(ParserError::InvalidNumberOfArgs, "Too many arguments");
+		auto const firstExtra = cntx.offset + arguments.size();
+		auto error = makeParserError(ParserError::InvalidNumberOfArgs, firstExtra, tokenAt(cntx.argv, firstExtra));
+		if (!tolerate(cntx, error)) {
+			return error;
+		}
+
+		end = firstExtra;  // Extra values are skipped
     }
 
     auto positionalArgument = cntx.offset;
 
     // Parse array of strings until we error out or there is no more values to consume:
     for (decltype(positionalArgument) i = 0;
-         i < arguments.size() && positionalArgument < cntx.argv.size();
+         i < arguments.size() && positionalArgument < end;
          ++positionalArgument) {
 
-		// Check that we didn't hit argv end:
-        if (!cntx.argv[positionalArgument]) {
-			return makeParserError(ParserError::InvalidInput, "null string as input");
-        }
-
         auto& targetArg = arguments[i];
-        auto const subCntx = cntx.withOffsetAndName(positionalArgument, targetArg.name());
-
-        auto const arg = StringView {cntx.argv[positionalArgument]};
-        auto maybeError = targetArg.match(arg, subCntx);
-        if (maybeError) {
+		if (expectsTrailingArgument && targetArg.isIndependent() && i + 1 == arguments.size()) {
+			auto maybeError = matchIndependentArgument(targetArg, cntx, positionalArgument);
+			if (maybeError) {
+				return maybeError.move();
+			}
+
+			positionalArgument = end;
+			break;
+		}
+
+        auto maybeError = matchArgument(targetArg, cntx, positionalArgument);
+        if (maybeError && !tolerate(cntx, maybeError.get())) {
 			return maybeError.move();
         }
 
@@ -200,25 +381,49 @@ parseArguments(Parser::Context const& cntx,
         }
     }
 
-    if (cntx.argv.size() == positionalArgument) {
+    if (end == positionalArgument) {
         return Ok(positionalArgument);
     }
 
-	return makeParserError(ParserError::InvalidNumberOfArgs, "Not enough arguments");
+	auto error = makeParserError(ParserError::InvalidNumberOfArgs,
+								 positionalArgument,
+								 tokenAt(cntx.argv, positionalArgument));
+	if (!tolerate(cntx, error)) {
+		return error;
+	}
+
+	return Ok(positionalArgument);
 }
 
 
-Result<Parser::ParseResult, Error>
+Result<Parser::Command const*, Error>
+resolveCommand(Parser::Command const& cmd, Parser::Context const& cntx) {
+	if (cntx.trace) {
+		cntx.trace->resolved(cmd);
+	}
+
+	return Ok(&cmd);
+}
+
+
+Result<Parser::Command const*, Error>
 parseCommand(Parser::Command const& cmd, Parser::Context const& cntx) {
 
+	Parser::Constraint::OptionMask seen = 0;
     auto optionsParsingResult = parseOptions(cntx,
                                              cmd.options(),
                                              cntx.parser.optionPrefix(),
-                                             cntx.parser.valueSeparator());
+                                             cntx.parser.valueSeparator(),
+											 seen);
     if (!optionsParsingResult) {
 		return optionsParsingResult.moveError();
     }
 
+	auto maybeViolation = cmd.checkConstraints(seen);
+	if (maybeViolation && !tolerate(cntx, maybeViolation.get())) {
+		return maybeViolation.move();
+	}
+
     auto const positionalArgument = optionsParsingResult.unwrap();
 
     // Positional arguments processing
@@ -228,46 +433,373 @@ parseCommand(Parser::Command const& cmd, Parser::Context const& cntx) {
             auto const subcmdName = StringView {cntx.argv[positionalArgument]};
             auto const cmdIt = cmd.commands().find(subcmdName);
             if (cmdIt == cmd.commands().end()) {
-				return makeParserError(ParserError::UnexpectedValue, "Command not supported");
+				// Nothing to resynchronize on: tokens that follow belong to an unknown command
+				auto error = makeParserError(ParserError::UnexpectedValue, positionalArgument, subcmdName);
+				tolerate(cntx, error);
+				return error;
             }
 
-            return parseCommand(cmdIt->second, cntx.withOffsetAndName(positionalArgument + 1, subcmdName));
+            // A lazy sub-command is built only once it has been selected
+            auto maybeSubcmd = cmdIt->second.resolve();
+            if (!maybeSubcmd) {
+				tolerate(cntx, maybeSubcmd.getError());
+				return maybeSubcmd.moveError();
+            }
+
+			if (cntx.trace) {
+				cntx.trace->commandSelected({positionalArgument, 0, subcmdName.size()});
+			}
+
+            return parseCommand(*maybeSubcmd.unwrap(),
+								cntx.withCommand(maybeSubcmd.unwrap(), positionalArgument + 1, subcmdName));
         } else if (!cmd.arguments().empty()) {
             auto parseResult = parseArguments(cntx.withOffsetAndName(positionalArgument, {}), cmd.arguments());
             if (!parseResult) {
 				return parseResult.moveError();
             }
 
-			return Ok(cmd.action());
+			return resolveCommand(cmd, cntx);
         } else {
-			return makeParserError(ParserError::UnexpectedValue, "Unexpected arguments given");
+			auto error = makeParserError(ParserError::UnexpectedValue,
+										 positionalArgument,
+										 tokenAt(cntx.argv, positionalArgument));
+			if (!tolerate(cntx, error)) {
+				return error;
+			}
+
+			return resolveCommand(cmd, cntx);
         }
 
     } else {
 		auto const& arguments = cmd.arguments();
 		if ((arguments.empty() && cmd.commands().empty()) ||
 			(!arguments.empty() && arguments.back().isTrailing())) {
-			return Ok(cmd.action());
+			return resolveCommand(cmd, cntx);
         }
 
-		return makeParserError(ParserError::InvalidNumberOfArgs, "Not enough arguments");
+		auto error = makeParserError(ParserError::InvalidNumberOfArgs, cntx.argv.size(), {});
+		if (!tolerate(cntx, error)) {
+			return error;
+		}
+
+		return resolveCommand(cmd, cntx);
     }
 }
 
 
-Result<Parser::ParseResult, Error>
-Parser::parse(Solace::ArrayView<const char*> args) const {
+/**
+ * Find an option matching a name.
+ * @return Matching option or null if there is none.
+ */
+Parser::Option const*
+findOption(std::vector<Parser::Option> const& options, StringView name) noexcept {
+	for (auto const& option : options) {
+		if (option.isMatch(name)) {
+			return &option;
+		}
+	}
+
+	return nullptr;
+}
+
+
+/**
+ * Scan options of the start command, up to the first positional token, for pre-scanned top-level options,
+ * such as help and version, so that they are handled even if the start command is a multi-call applet.
+ * Tokens past the first positional one belong to a sub-command and are left to it: a sub-command may have
+ * options of the same names. So may an applet, in which case its own option takes precedence.
+ * Actions of all the pre-scanned options found are called, in order, until one of them returns an error.
+ * The parse of the start command does not call them again, @see parseOptions().
+ * @return Error returned by the action of a pre-scanned option, if any.
+ */
+Optional<Error>
+preScanOptions(Parser::Context const& cntx) {
+	auto const& options = cntx.parser.defaultAction().options();
+	auto const& command = cntx.currentCommand();
+	auto const prefix = cntx.parser.optionPrefix();
+
+	for (decltype(cntx.offset) i = cntx.offset; i < cntx.argv.size(); ++i) {
+		if (!cntx.argv[i]) {  // Reported by the parse itself
+			return none;
+		}
+
+		auto const arg = StringView{cntx.argv[i]};
+		if (!arg.startsWith(prefix)) {  // First positional token: the rest is not parsed by the start command
+			return none;
+		}
+
+		auto [argName, argValue] = parseOption(arg, prefix, cntx.parser.valueSeparator());
+		auto const ownOption = findOption(command.options(), argName);
+		auto const option = findOption(options, argName);
+		if (!option || !option->isPreScanned() || (ownOption && ownOption != option)) {
+			// Skip the value of the option, so that it is not mistaken for a positional token
+			if (ownOption && argValue.isNone() &&
+				Parser::ArgumentValue::NotRequired != ownOption->argumentExpectations() &&
+				i + 1 < cntx.argv.size() && cntx.argv[i + 1] && !StringView{cntx.argv[i + 1]}.startsWith(prefix)) {
+				++i;
+			}
+
+			continue;
+		}
+
+		auto consumeValue = false;
+		if (Parser::ArgumentValue::NotRequired == option->argumentExpectations()) {
+			argValue = none;
+		} else if (argValue.isNone() && i + 1 < cntx.argv.size() && cntx.argv[i + 1]) {
+			auto nextArg = StringView{cntx.argv[i + 1]};
+			if (!nextArg.startsWith(prefix)) {
+				argValue = nextArg;
+				consumeValue = true;
+			}
+		}
+
+		if (argValue.isNone() && Parser::ArgumentValue::Required == option->argumentExpectations()) {
+			continue;  // Let the parse report the missing value
+		}
+
+		auto const optCntx = cntx.withOffsetAndName(i, argName);
+		auto const mark = cntx.trace ? cntx.trace->size() : 0;
+		auto maybeError = option->match(argValue, optCntx);
+		if (maybeError) {
+			return maybeError;
+		}
+
+		if (cntx.trace) {
+			cntx.trace->optionApplied(*option, mark, argValue, optCntx);
+		}
+
+		if (consumeValue) {
+			++i;
+		}
+	}
+
+	return none;
+}
+
+
+/// Run a deferred task, reporting an exception escaping it as an error.
+Result<void, Error>
+runDeferredTask(Parser::DeferredTask const& task, CancellationToken const& cancellation) noexcept {
+	try {
+		return task(cancellation);
+	} catch (...) {
+		return makeParserError(ParserError::OptionParsing, "deferred task");
+	}
+}
+
+
+/**
+ * Run deferred option tasks concurrently, on up to concurrencyLimit threads, and wait for all of them to complete.
+ * Tasks run on the calling thread and on workers of the shared pool, so no thread is started per parse.
+ * Tasks are cancelled once any of them fails.
+ * @return Error of the first failed task in the order tasks have been given.
+ */
+Optional<Error>
+runDeferredTasks(std::vector<Parser::DeferredTask>& tasks, uint32 concurrencyLimit) {
+	if (tasks.size() == 1) {
+		auto result = runDeferredTask(tasks.front(), CancellationToken{});
+		if (!result) {
+			return result.moveError();
+		}
+
+		return none;
+	}
+
+	if (concurrencyLimit == 0) {
+		concurrencyLimit = std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	CancellationToken cancellation;
+	std::vector<Optional<Error>> errors(tasks.size());
+
+	forEachConcurrently(ThreadPool::shared(), static_cast<uint32>(tasks.size()), concurrencyLimit,
+						[&tasks, &errors, &cancellation](uint32 index) {
+		auto result = runDeferredTask(tasks[index], cancellation);
+		if (!result) {
+			errors[index] = result.moveError();
+			cancellation.cancel();
+		}
+
+		return true;  // Tasks still queued are run to observe cancellation
+	});
+
+	// Prefer the error that has caused cancellation over errors of cancelled tasks
+	Optional<Error> firstError;
+	for (auto& error : errors) {
+		if (!error) {
+			continue;
+		}
+
+		bool const isCancelled = (error.get().domain() == kParserErrorCatergory &&
+								  parserErrorCode(error.get()) == ParserError::Cancelled);
+		if (!isCancelled) {
+			return error.move();
+		}
+
+		if (!firstError) {
+			firstError = error.move();
+		}
+	}
+
+	return firstError;
+}
+
+
+Result<Parser::Command const*, Error>
+parseArgs(Parser const& parser,
+		  ArrayView<const char*> args,
+		  Parser::Pass pass,
+		  StringArena* arena,
+		  ParseTrace* trace,
+		  Diagnostics* diagnostics = nullptr) {
     if (args.empty()) {
-        if (_defaultAction.arguments().empty() && _defaultAction.commands().empty()) {
-			return Ok(_defaultAction.action());
+		auto const& defaultAction = parser.defaultAction();
+		if (defaultAction.arguments().empty() && defaultAction.commands().empty()) {
+			if (trace) {
+				trace->resolved(defaultAction);
+			}
+
+			return Ok(&defaultAction);
         }
 
 		return makeParserError(ParserError::InvalidNumberOfArgs, "Not enough arguments");
     }
 
-    return parseCommand(_defaultAction, {
+	// In multi-call mode the name of the program may select the command to start from
+	auto start = &parser.defaultAction();
+	auto const applet = parser.appletName(args);
+	if (!applet.empty()) {
+		auto maybeApplet = start->commands().find(applet)->second.resolve();
+		if (!maybeApplet) {
+			return maybeApplet.moveError();
+		}
+
+		start = maybeApplet.unwrap();
+		if (trace) {
+			auto const nameOffset = static_cast<ParseTrace::size_type>(applet.data() - args[0]);
+			trace->commandSelected({0, nameOffset, applet.size()});
+		}
+	}
+
+	std::vector<Parser::DeferredTask> deferred;
+	auto const cntx = Parser::Context{
                             args,
                             1,
                             args[0],
-                            *this});
+							parser,
+							pass,
+							arena,
+							trace,
+							&deferred,
+							start,
+							diagnostics};
+
+	if (Parser::Pass::Startup == pass && !diagnostics) {
+		auto maybeError = preScanOptions(cntx);
+		if (maybeError) {
+			return maybeError.move();
+		}
+	}
+
+	auto result = parseCommand(*start, cntx);
+
+	// Command line is valid, start deferred option tasks
+	if (result && !deferred.empty()) {
+		auto maybeError = parser.runDeferred(deferred);
+		if (maybeError) {
+			return maybeError.move();
+		}
+	}
+
+	return result;
+}
+
+
+Result<Parser::ParseResult, Error>
+toAction(Result<Parser::Command const*, Error>&& maybeCommand) {
+	if (!maybeCommand) {
+		return maybeCommand.moveError();
+	}
+
+	return Ok(maybeCommand.unwrap()->action());
+}
+
+
+Result<Parser::ParseResult, Error>
+Parser::parse(ArrayView<const char*> args, Pass pass) const {
+	return toAction(parseArgs(*this, args, pass, nullptr, nullptr));
+}
+
+
+Result<Parser::Command const*, Error>
+Parser::resolve(ArrayView<const char*> args, Pass pass) const {
+	return parseArgs(*this, args, pass, nullptr, nullptr);
+}
+
+
+Optional<Error>
+Parser::runDeferred(std::vector<DeferredTask>& tasks) const {
+	if (tasks.empty()) {
+		return none;
+	}
+
+	return runDeferredTasks(tasks, concurrencyLimit());
+}
+
+
+Result<Parser::Command const*, Error>
+Parser::validate(ArrayView<const char*> args, Diagnostics& diagnostics, Pass pass) const {
+	auto const nbReported = diagnostics.total();
+	auto result = parseArgs(*this, args, pass, nullptr, nullptr, &diagnostics);
+	if (!result) {
+		// Errors found before parsing has started have not been reported yet
+		if (diagnostics.total() == nbReported) {
+			diagnostics.report(result.getError());
+		}
+
+		return result;
+	}
+
+	if (diagnostics.total() != nbReported) {
+		return nbReported < diagnostics.size()
+				? Error{diagnostics.errors()[nbReported]}
+				: makeParserError(ParserError::InvalidInput, "Too many errors");
+	}
+
+	return result;
+}
+
+
+StringView
+Parser::appletName(ArrayView<const char*> args) const noexcept {
+	if (!_multiCall || args.empty() || !args[0]) {
+		return {};
+	}
+
+	auto const program = StringView{args[0]};
+	auto nameStart = program.size();
+	while (nameStart > 0 && program[nameStart - 1] != '/') {
+		--nameStart;
+	}
+
+	auto const name = program.substring(nameStart);
+	return (_defaultAction.commands().find(name) != _defaultAction.commands().end())
+			? name
+			: StringView{};
+}
+
+
+Result<Parser::ParseResult, Error>
+Parser::parse(ArrayView<const char*> args, StringArena& arena, Pass pass) const {
+	StringArena::ParseScope const scope{&arena};
+
+	return toAction(parseArgs(*this, args, pass, &arena, nullptr));
+}
+
+
+Result<Parser::ParseResult, Error>
+Parser::parse(ArrayView<const char*> args, ParseTrace& trace, StringArena* arena, Pass pass) const {
+	StringArena::ParseScope const scope{arena};
+
+	return toAction(parseArgs(*this, args, pass, arena, &trace));
 }
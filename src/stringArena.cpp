@@ -0,0 +1,136 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/stringArena.cpp
+ *
+*******************************************************************************/
+
+#include "clime/stringArena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace /* anonymous */ {
+
+#ifndef NDEBUG
+/// Fill pattern for the released memory
+constexpr int kPoisonByte = 0xDD;
+#endif
+
+}  // anonymous namespace
+
+
+StringArena::~StringArena() {
+	assert(_activeParses == 0 && "StringArena destroyed while parse is in progress");
+}
+
+
+StringArena::StringArena(size_type blockSize) noexcept
+	: _blockSize{blockSize > 0 ? blockSize : kDefaultBlockSize}
+{
+}
+
+
+StringView
+StringArena::copy(StringView value) {
+	size_type const required = value.size() + 1;  // Copy is null-terminated
+
+	if (_blocks.empty() || _blocks.back().size - _blockUsed < required) {
+		auto const size = std::max(required, _blockSize);
+		auto const insertAt = _blocks.empty()
+				? _blocks.end()
+				: _blocks.end() - 1;
+
+		// Oversized value gets its own block, leaving the current block to be used by the following values.
+		bool const dedicated = (required > _blockSize) && !_blocks.empty();
+		auto it = _blocks.insert(dedicated ? insertAt : _blocks.end(), Block{std::make_unique<char[]>(size), size});
+		_capacity += size;
+
+		if (dedicated) {
+			char* dest = it->data.get();
+			std::memcpy(dest, value.data(), value.size());
+			dest[value.size()] = 0;
+			_used += required;
+
+			return {dest, value.size()};
+		}
+
+		_blockUsed = 0;
+	}
+
+	char* dest = _blocks.back().data.get() + _blockUsed;
+	std::memcpy(dest, value.data(), value.size());
+	dest[value.size()] = 0;
+	_blockUsed += required;
+	_used += required;
+
+	return {dest, value.size()};
+}
+
+
+void
+StringArena::reset() noexcept {
+	assert(_activeParses == 0 && "StringArena reset while parse is in progress");
+
+	if (_blocks.empty()) {
+		return;
+	}
+
+#ifndef NDEBUG
+	for (auto& block : _blocks) {
+		std::memset(block.data.get(), kPoisonByte, block.size);
+	}
+#endif
+
+	// Keep the first block for reuse
+	_blocks.erase(_blocks.begin() + 1, _blocks.end());
+	_capacity = _blocks.front().size;
+	_blockUsed = 0;
+	_used = 0;
+}
+
+
+bool
+StringArena::owns(StringView value) const noexcept {
+	for (auto const& block : _blocks) {
+		auto const* begin = block.data.get();
+		if (value.data() >= begin && value.data() + value.size() < begin + block.size) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void
+StringArena::beginParse() noexcept {
+	assert(_activeParses == 0 && "StringArena must not be shared by concurrent parses");
+	_activeParses += 1;
+}
+
+
+void
+StringArena::endParse() noexcept {
+	assert(_activeParses > 0);
+	_activeParses -= 1;
+}
@@ -0,0 +1,33 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * @file: clime/threadPool.cpp
+ *
+*******************************************************************************/
+
+#include "clime/threadPool.hpp"
+
+
+using namespace clime;
+
+
+ThreadPool&
+ThreadPool::shared() {
+	// Note: The pool is never destroyed, so exit() does not wait for workers, nor joins workers lost by fork()
+	static auto* const pool = new ThreadPool{};
+
+	return *pool;
+}
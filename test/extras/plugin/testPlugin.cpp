@@ -0,0 +1,35 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/plugin/testPlugin.cpp
+ * @brief: Plugin loaded by test_pluginCommand.cpp
+*******************************************************************************/
+#include <clime/extras/pluginCommand.hpp>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+extern "C" int clime_plugin_command(Parser::Command* command) {
+	auto noop = []() -> Result<void, Error> { return Ok(); };
+
+	command->action(noop);
+	command->addCommand("nested", "Nested plugin command", noop);
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_argvCorpus.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/argvCorpus.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+class TestArgvCorpus: public ::testing::Test {
+public:
+
+	void SetUp() override {
+		char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+		ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+		dir = dirTemplate;
+		path = dir + "/corpus.bin";
+	}
+
+	void TearDown() override {
+		unlink(path.c_str());
+		rmdir(dir.c_str());
+	}
+
+	std::string dir;
+	std::string path;
+};
+
+
+TEST_F(TestArgvCorpus, captureAndLoad) {
+	const char* first[] = {"tool", "--port=80", "serve"};
+	const char* second[] = {"tool", "", "status"};
+
+	setenv(extras::kArgvCorpusEnv, path.c_str(), 1);
+	extras::captureArgv(arrayView(first));
+	extras::captureArgv(arrayView(second));
+	unsetenv(extras::kArgvCorpusEnv);
+	extras::captureArgv(arrayView(first));  // Not captured once the variable is unset
+
+	auto maybeCorpus = extras::ArgvCorpus::load(path.c_str());
+	ASSERT_TRUE(maybeCorpus.isOk());
+
+	auto& corpus = maybeCorpus.unwrap();
+	ASSERT_EQ(2U, corpus.size());
+	ASSERT_EQ(3U, corpus[0].size());
+	EXPECT_EQ(StringView("--port=80"), StringView(corpus[0][1]));
+	EXPECT_EQ(StringView(""), StringView(corpus[1][1]));
+	EXPECT_EQ(StringView("status"), StringView(corpus[1][2]));
+}
+
+
+TEST_F(TestArgvCorpus, saveRoundTrip) {
+	extras::ArgvCorpus corpus;
+	for (int i = 0; i < 1000; ++i) {  // Enough to move the token buffer several times
+		auto const value = "--count=" + std::to_string(i);
+		const char* args[] = {"tool", value.c_str()};
+		corpus.append(arrayView(args));
+	}
+
+	ASSERT_TRUE(corpus.save(path.c_str()).isOk());
+
+	auto maybeCorpus = extras::ArgvCorpus::load(path.c_str());
+	ASSERT_TRUE(maybeCorpus.isOk());
+	ASSERT_EQ(corpus.size(), maybeCorpus.unwrap().size());
+	EXPECT_EQ(StringView("--count=0"), StringView(maybeCorpus.unwrap()[0][1]));
+	EXPECT_EQ(StringView("--count=999"), StringView(maybeCorpus.unwrap()[999][1]));
+
+	// Truncated file is rejected
+	ASSERT_EQ(0, truncate(path.c_str(), 5));
+	EXPECT_TRUE(extras::ArgvCorpus::load(path.c_str()).isError());
+}
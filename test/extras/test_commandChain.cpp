@@ -0,0 +1,166 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_commandChain.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/commandChain.hpp>
+#include <clime/extras/threadPool.hpp>
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+class TestCommandChain: public ::testing::Test {
+public:
+
+	TestCommandChain()
+		: parser{"Test chain"}
+	{
+		parser.options({
+			{{"env"}, "Environment", &env}
+		});
+		parser.commands({
+			{"build", {"Build a target", {{"target", "Target to build", &target}}, [this]() -> Result<void, Error> {
+					record("build " + std::string{target.data(), target.size()});
+					return Ok();
+				}}},
+			{"docs", {"Build docs", [this]() -> Result<void, Error> {
+					record("docs");
+					return Ok();
+				}}},
+			{"deploy", {"Deploy", [this]() -> Result<void, Error> {
+					record("deploy");
+					return Ok();
+				}}},
+			{"fail", {"Always fails", []() -> Result<void, Error> {
+					return makeParserError(ParserError::InvalidInput, "fail");
+				}}}
+		});
+	}
+
+	void record(std::string event) {
+		std::lock_guard<std::mutex> guard{lock};
+		events.emplace_back(mv(event));
+	}
+
+	StringView target;
+	StringView env;
+	std::mutex lock;
+	std::vector<std::string> events;
+	Parser parser;
+};
+
+
+TEST_F(TestCommandChain, splitIntoGroups) {
+	const char* argv[] = {"prog", "build", "x", "--", "docs", "::", "deploy"};
+	auto const segments = extras::splitChain(arrayView(argv));
+
+	ASSERT_EQ(3U, segments.size());
+	EXPECT_EQ(3U, segments[0].args.size());
+	EXPECT_EQ(0U, segments[0].group);
+	EXPECT_EQ(0U, segments[1].group);
+	EXPECT_EQ(1U, segments[2].group);
+	EXPECT_EQ(StringView("prog"), StringView(segments[2].args[0]));
+	EXPECT_EQ(StringView("deploy"), StringView(segments[2].args[1]));
+}
+
+TEST_F(TestCommandChain, sequentialGroupsRunInOrder) {
+	extras::ThreadPool pool{2};
+
+	const char* argv[] = {"prog", "build", "x", "--", "docs", "::", "build", "y", "::", "deploy"};
+	auto const segments = extras::runChain(parser, arrayView(argv), pool);
+	ASSERT_EQ(4U, segments.size());
+	EXPECT_TRUE(extras::isSuccessful(segments));
+
+	ASSERT_EQ(4U, events.size());
+	// First group may complete in any order
+	EXPECT_TRUE((events[0] == "build x" && events[1] == "docs") || (events[0] == "docs" && events[1] == "build x"));
+	EXPECT_EQ("build y", events[2]);
+	EXPECT_EQ("deploy", events[3]);
+}
+
+TEST_F(TestCommandChain, parseErrorPreventsExecution) {
+	InlineExecutor executor;
+
+	const char* argv[] = {"prog", "docs", "::", "deploy", "extra-argument"};
+	auto const segments = extras::runChain(parser, arrayView(argv), executor);
+	ASSERT_EQ(2U, segments.size());
+	EXPECT_TRUE(segments[0].error.isSome());
+	EXPECT_TRUE(segments[1].error.isSome());
+	EXPECT_NE(static_cast<int>(ParserError::Cancelled), segments[1].error.get().value());
+	EXPECT_TRUE(events.empty());
+}
+
+TEST_F(TestCommandChain, failureSkipsLaterGroups) {
+	InlineExecutor executor;
+
+	const char* argv[] = {"prog", "fail", "--", "docs", "::", "deploy"};
+	auto const segments = extras::runChain(parser, arrayView(argv), executor);
+	ASSERT_EQ(3U, segments.size());
+	EXPECT_EQ(static_cast<int>(ParserError::InvalidInput), segments[0].error.get().value());
+	EXPECT_TRUE(segments[1].error.isNone());
+	EXPECT_EQ(static_cast<int>(ParserError::Cancelled), segments[2].error.get().value());
+
+	ASSERT_EQ(1U, events.size());
+	EXPECT_EQ("docs", events[0]);
+}
+
+TEST_F(TestCommandChain, repeatedCommandInConcurrentGroupIsAnError) {
+	InlineExecutor executor;
+
+	const char* argv[] = {"prog", "build", "x", "--", "build", "y"};
+	auto const segments = extras::runChain(parser, arrayView(argv), executor);
+	ASSERT_EQ(2U, segments.size());
+	EXPECT_TRUE(segments[1].error.isSome());
+	EXPECT_TRUE(events.empty());
+}
+
+TEST_F(TestCommandChain, lastGroupIsReparsedBeforeRunning) {
+	InlineExecutor executor;
+
+	const char* argv[] = {"prog", "build", "x", "::", "build", "y"};
+	auto const segments = extras::runChain(parser, arrayView(argv), executor);
+	ASSERT_EQ(2U, segments.size());
+	EXPECT_TRUE(extras::isSuccessful(segments));
+
+	ASSERT_EQ(2U, events.size());
+	EXPECT_EQ("build x", events[0]);
+	EXPECT_EQ("build y", events[1]);
+}
+
+TEST_F(TestCommandChain, sharedOptionInConcurrentGroupIsAnError) {
+	InlineExecutor executor;
+
+	const char* argv[] = {"prog", "--env", "dev", "build", "x", "--", "--env", "prod", "deploy"};
+	auto const segments = extras::runChain(parser, arrayView(argv), executor);
+	ASSERT_EQ(2U, segments.size());
+	EXPECT_TRUE(segments[1].error.isSome());
+	EXPECT_TRUE(events.empty());
+
+	// Sequential segments may give the same option
+	const char* sequentialArgv[] = {"prog", "--env", "dev", "build", "x", "::", "--env", "prod", "deploy"};
+	EXPECT_TRUE(extras::isSuccessful(extras::runChain(parser, arrayView(sequentialArgv), executor)));
+	EXPECT_EQ(StringView("prod"), env);
+}
@@ -0,0 +1,229 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_commandServer.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/commandServer.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+class TestCommandServer: public ::testing::Test {
+public:
+
+	TestCommandServer()
+		: parser{"Test server", {
+				{{"n", "name"}, "Name to greet", &name}
+			}}
+	{
+		parser.commands({
+			{"greet", {"Greet the user", [this]() -> Result<void, Error> {
+					std::cout << "Hello " << name;
+					return Ok();
+				}}},
+			{"fail", {"Fail the command", []() -> Result<void, Error> {
+					return makeParserError(ParserError::InvalidInput, "failed");
+				}}},
+			{"throw", {"Throw an exception", []() -> Result<void, Error> {
+					throw std::runtime_error{"action failed"};
+				}}}
+		});
+	}
+
+	StringView name{"nobody"};
+	Parser parser;
+};
+
+
+TEST_F(TestCommandServer, executeCapturesOutput) {
+	auto server = extras::CommandServer{parser, [this]() { name = "nobody"; }};
+
+	const char* argv[] = {"prog", "--name", "Alice", "greet"};
+	auto response = server.execute(arrayView(argv));
+	EXPECT_EQ(0, response.status);
+	EXPECT_EQ("Hello Alice", response.output);
+
+	// Bindings are reset between requests
+	const char* argvDefault[] = {"prog", "greet"};
+	response = server.execute(arrayView(argvDefault));
+	EXPECT_EQ(0, response.status);
+	EXPECT_EQ("Hello nobody", response.output);
+}
+
+TEST_F(TestCommandServer, executeReportsFailures) {
+	auto server = extras::CommandServer{parser};
+
+	const char* argvFail[] = {"prog", "fail"};
+	EXPECT_EQ(EXIT_FAILURE, server.execute(arrayView(argvFail)).status);
+
+	const char* argvInvalid[] = {"prog", "unknown-command"};
+	auto const response = server.execute(arrayView(argvInvalid));
+	EXPECT_EQ(EXIT_FAILURE, response.status);
+	EXPECT_FALSE(response.output.empty());
+}
+
+TEST_F(TestCommandServer, throwingActionFailsOnlyItsRequest) {
+	auto server = extras::CommandServer{parser};
+
+	const char* argvThrow[] = {"prog", "throw"};
+	auto const response = server.execute(arrayView(argvThrow));
+	EXPECT_EQ(EXIT_FAILURE, response.status);
+	EXPECT_NE(std::string::npos, response.output.find("action failed"));
+
+	const char* argv[] = {"prog", "greet"};
+	EXPECT_EQ(0, server.execute(arrayView(argv)).status);
+}
+
+TEST_F(TestCommandServer, serveStream) {
+	int requestPipe[2];
+	int responsePipe[2];
+	ASSERT_EQ(0, pipe(requestPipe));
+	ASSERT_EQ(0, pipe(responsePipe));
+
+	const char* argv1[] = {"prog", "--name", "Bob", "greet"};
+	const char* argv2[] = {"prog", "fail"};
+	ASSERT_TRUE(extras::writeRequest(requestPipe[1], arrayView(argv1)).isOk());
+	ASSERT_TRUE(extras::writeRequest(requestPipe[1], arrayView(argv2)).isOk());
+	close(requestPipe[1]);
+
+	auto server = extras::CommandServer{parser};
+	EXPECT_TRUE(server.serve(requestPipe[0], responsePipe[1]).isOk());
+	close(requestPipe[0]);
+	close(responsePipe[1]);
+
+	auto reader = extras::FrameReader{responsePipe[0]};
+	auto response1 = reader.readResponse();
+	ASSERT_TRUE(response1.isOk());
+	EXPECT_EQ(0, response1.unwrap().status);
+	EXPECT_EQ("Hello Bob", response1.unwrap().output);
+
+	auto response2 = reader.readResponse();
+	ASSERT_TRUE(response2.isOk());
+	EXPECT_EQ(EXIT_FAILURE, response2.unwrap().status);
+	close(responsePipe[0]);
+}
+
+TEST_F(TestCommandServer, truncatedFrameIsAnError) {
+	int requestPipe[2];
+	ASSERT_EQ(0, pipe(requestPipe));
+
+	char const frame[] = "3\0prog\0greet";
+	ASSERT_EQ(static_cast<ssize_t>(sizeof(frame) - 1), write(requestPipe[1], frame, sizeof(frame) - 1));
+	close(requestPipe[1]);
+
+	std::vector<const char*> args;
+	auto reader = extras::FrameReader{requestPipe[0]};
+	EXPECT_TRUE(reader.readRequest(args).isError());
+	close(requestPipe[0]);
+}
+
+TEST_F(TestCommandServer, forwardCommandToListeningServer) {
+	char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+	auto const socketPath = std::string{dirTemplate} + "/server.sock";
+
+	auto server = extras::CommandServer{parser, [this]() { name = "nobody"; }};
+	auto serverThread = std::thread{[&]() {
+		EXPECT_TRUE(server.listen(socketPath.c_str(), 2).isOk());
+	}};
+
+	const char* argv[] = {"prog", "-n", "Carol", "greet"};
+	std::ostringstream output;
+	auto status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	for (int retry = 0; !status && retry < 100; ++retry) {  // Wait for the server to start
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	}
+
+	server.stop();
+	serverThread.join();
+	rmdir(dirTemplate);
+
+	ASSERT_TRUE(status.isOk());
+	EXPECT_EQ(0, status.unwrap());
+	EXPECT_EQ("Hello Carol", output.str());
+}
+
+TEST_F(TestCommandServer, stopBeforeListenIsNotLost) {
+	char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+	auto const socketPath = std::string{dirTemplate} + "/server.sock";
+
+	auto server = extras::CommandServer{parser};
+	server.stop();
+	EXPECT_TRUE(server.listen(socketPath.c_str(), 1).isOk());  // Returns without accepting connections
+
+	// Stop request has been consumed: server can listen again
+	auto serverThread = std::thread{[&]() {
+		EXPECT_TRUE(server.listen(socketPath.c_str(), 1).isOk());
+	}};
+
+	const char* argv[] = {"prog", "greet"};
+	std::ostringstream output;
+	auto status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	for (int retry = 0; !status && retry < 100; ++retry) {  // Wait for the server to start
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	}
+
+	server.stop();
+	serverThread.join();
+	rmdir(dirTemplate);
+
+	EXPECT_TRUE(status.isOk());
+}
+
+TEST_F(TestCommandServer, listeningSocketIsPrivateAndNotStolen) {
+	char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+	auto const socketPath = std::string{dirTemplate} + "/server.sock";
+
+	auto maybeSocket = extras::listenUnixSocket(socketPath.c_str());
+	ASSERT_TRUE(maybeSocket.isOk());
+
+	struct stat socketStat;
+	ASSERT_EQ(0, stat(socketPath.c_str(), &socketStat));
+	EXPECT_EQ(static_cast<mode_t>(S_IRUSR | S_IWUSR), socketStat.st_mode & 0777);
+
+	// Socket of a running server is not removed by another instance
+	EXPECT_TRUE(extras::listenUnixSocket(socketPath.c_str()).isError());
+
+	// Once the server is gone its socket is stale and is replaced
+	close(maybeSocket.unwrap());
+	auto maybeReplacement = extras::listenUnixSocket(socketPath.c_str());
+	ASSERT_TRUE(maybeReplacement.isOk());
+
+	close(maybeReplacement.unwrap());
+	unlink(socketPath.c_str());
+	rmdir(dirTemplate);
+}
@@ -0,0 +1,142 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_forkServer.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/forkServer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+int gRequestCounter = 0;
+}  // namespace
+
+
+TEST(TestForkServer, childStateDoesNotLeakIntoParent) {
+	StringView name{"nobody"};
+	auto parser = Parser{"Test fork server", {
+			{{"n", "name"}, "Name to greet", &name}
+		}};
+	parser.commands({
+		{"greet", {"Greet the user", [&name]() -> Result<void, Error> {
+				gRequestCounter += 1;
+				printf("%d:", gRequestCounter);
+				fflush(stdout);
+				std::cout << "Hello " << name;
+				return Ok();
+			}}}
+	});
+
+	char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+	auto const socketPath = std::string{dirTemplate} + "/zygote.sock";
+
+	auto server = extras::ForkServer{parser};
+	auto serverThread = std::thread{[&]() {
+		EXPECT_TRUE(server.listen(socketPath.c_str()).isOk());
+	}};
+
+	const char* argv[] = {"prog", "-n", "Dave", "greet"};
+	std::ostringstream output;
+	auto status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	for (int retry = 0; !status && retry < 100; ++retry) {  // Wait for the server to start
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	}
+
+	std::ostringstream secondOutput;
+	auto secondStatus = extras::forwardCommand(socketPath.c_str(), arrayView(argv), secondOutput);
+
+	server.stop();
+	serverThread.join();
+	rmdir(dirTemplate);
+
+	ASSERT_TRUE(status.isOk());
+	EXPECT_EQ(0, status.unwrap());
+	EXPECT_EQ("1:Hello Dave", output.str());
+
+	// Each request starts from the parent's state
+	ASSERT_TRUE(secondStatus.isOk());
+	EXPECT_EQ("1:Hello Dave", secondOutput.str());
+	EXPECT_EQ(0, gRequestCounter);
+	EXPECT_EQ(StringView("nobody"), name);
+}
+
+TEST(TestForkServer, throwingActionOnlyFailsTheChild) {
+	auto parser = Parser{"Test fork server"};
+	parser.commands({
+		{"throw", {"Throw an exception", []() -> Result<void, Error> {
+				throw std::runtime_error{"action failed"};
+			}}},
+		{"greet", {"Greet the user", []() -> Result<void, Error> {
+				std::cout << "Hello";
+				return Ok();
+			}}}
+	});
+
+	char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+	auto const socketPath = std::string{dirTemplate} + "/zygote.sock";
+
+	auto server = extras::ForkServer{parser};
+	auto serverThread = std::thread{[&]() {
+		EXPECT_TRUE(server.listen(socketPath.c_str()).isOk());
+	}};
+
+	const char* argv[] = {"prog", "greet"};
+	std::ostringstream output;
+	auto status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	for (int retry = 0; !status && retry < 100; ++retry) {  // Wait for the server to start
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		status = extras::forwardCommand(socketPath.c_str(), arrayView(argv), output);
+	}
+
+	const char* throwArgv[] = {"prog", "throw"};
+	std::ostringstream throwOutput;
+	auto throwStatus = extras::forwardCommand(socketPath.c_str(), arrayView(throwArgv), throwOutput);
+
+	std::ostringstream secondOutput;
+	auto secondStatus = extras::forwardCommand(socketPath.c_str(), arrayView(argv), secondOutput);
+
+	server.stop();
+	serverThread.join();
+	rmdir(dirTemplate);
+
+	ASSERT_TRUE(status.isOk());
+	EXPECT_EQ("Hello", output.str());
+
+	// Child exits without a response, the parent keeps serving
+	EXPECT_TRUE(throwStatus.isError());
+	ASSERT_TRUE(secondStatus.isOk());
+	EXPECT_EQ(0, secondStatus.unwrap());
+	EXPECT_EQ("Hello", secondOutput.str());
+}
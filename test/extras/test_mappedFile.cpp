@@ -0,0 +1,124 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_mappedFile.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/mappedFile.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+class TestMappedFile: public ::testing::Test {
+public:
+
+	void SetUp() override {
+		char dirTemplate[] = "/tmp/clime_test_XXXXXX";
+		ASSERT_NE(nullptr, mkdtemp(dirTemplate));
+		dir = dirTemplate;
+
+		first = writeFile("first.txt", "first file content");
+		second = writeFile("second.txt", "2nd");
+	}
+
+	void TearDown() override {
+		unlink(first.c_str());
+		unlink(second.c_str());
+		rmdir(dir.c_str());
+	}
+
+	std::string writeFile(char const* name, char const* content) {
+		auto const path = dir + "/" + name;
+		auto file = fopen(path.c_str(), "w");
+		EXPECT_NE(nullptr, file);
+		fputs(content, file);
+		fclose(file);
+
+		return path;
+	}
+
+	std::string dir;
+	std::string first;
+	std::string second;
+};
+
+
+TEST_F(TestMappedFile, optionAndTrailingArguments) {
+	extras::MappedFile dictionary;
+	std::vector<extras::MappedFile> inputs;
+
+	auto const option = "--dict=" + first;
+	const char* argv[] = {"prog", option.c_str(), first.c_str(), second.c_str()};
+
+	auto parser = Parser{"Test mapped files", {
+			{{"dict"}, "Dictionary", Parser::ArgumentValue::Required, extras::mapFileInto(&dictionary)}
+		}};
+	parser.arguments({
+		{"*", "Input files", extras::mapFileInto(&inputs)}
+	});
+
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+
+	ASSERT_TRUE(dictionary.isOpen());
+	EXPECT_EQ(StringView(first.c_str()), dictionary.path());
+	EXPECT_EQ(StringView("first file content"), dictionary.view());
+
+	ASSERT_EQ(2U, inputs.size());
+	EXPECT_EQ(StringView("first file content"), inputs[0].view());
+	EXPECT_EQ(StringView("2nd"), inputs[1].view());
+}
+
+TEST_F(TestMappedFile, missingFileIsParseError) {
+	std::vector<extras::MappedFile> inputs;
+	auto const missing = dir + "/no-such-file";
+	const char* argv[] = {"prog", first.c_str(), missing.c_str()};
+
+	auto parser = Parser{"Test mapped files"};
+	parser.arguments({
+		{"*", "Input files", extras::mapFileInto(&inputs)}
+	});
+
+	auto result = parser.parse(arrayView(argv));
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(StringView(missing.c_str()), result.getError().tag());
+
+	auto directory = extras::MappedFile::open(dir.c_str());
+	EXPECT_TRUE(directory.isError());
+}
+
+
+TEST_F(TestMappedFile, fileTooLargeForViewIsError) {
+	auto const huge = writeFile("huge.bin", "");
+	ASSERT_EQ(0, truncate(huge.c_str(), 5LL << 30));  // Sparse, takes no space
+
+	auto maybeFile = extras::MappedFile::open(huge.c_str());
+	unlink(huge.c_str());
+
+	ASSERT_TRUE(maybeFile.isError());
+	EXPECT_EQ(StringView(huge.c_str()), maybeFile.getError().tag());
+}
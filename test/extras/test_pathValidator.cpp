@@ -0,0 +1,191 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_pathValidator.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/pathValidator.hpp>
+#include <clime/parseCache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <string>
+#include <vector>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+TEST(TestPathValidator, reportsAllPathsWithPositions) {
+	std::vector<extras::PathStatus> reported;
+	auto validator = extras::PathValidator{
+			[&reported](ArrayView<extras::PathStatus const> results) -> Optional<Error> {
+				reported.assign(results.begin(), results.end());
+
+				for (auto const& status : results) {
+					if (!status.isOk()) {
+						return makeParserError(ParserError::InvalidInput, status.path);
+					}
+				}
+
+				return none;
+			},
+			4, R_OK, 8};
+
+	// Enough paths for several batches
+	std::vector<std::string> paths;
+	for (int i = 0; i < 100; ++i) {
+		paths.emplace_back((i == 42 || i == 77) ? "/no/such/path/" + std::to_string(i) : "/");
+	}
+
+	std::vector<const char*> argv{"prog"};
+	for (auto const& path : paths) {
+		argv.push_back(path.c_str());
+	}
+
+	auto parser = Parser{"Test path validator"};
+	parser.arguments({
+		{"*", "Paths", validator.collector()}
+	});
+
+	auto result = parser.parse(arrayView(argv.data(), argv.size()));
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(StringView(paths[42].c_str()), result.getError().tag());
+
+	ASSERT_EQ(100U, reported.size());
+	for (extras::PathStatus::size_type i = 0; i < reported.size(); ++i) {
+		EXPECT_EQ(i + 1, reported[i].position);
+		bool const isMissing = (i == 42 || i == 77);
+		EXPECT_EQ(isMissing ? ENOENT : 0, reported[i].errorCode);
+	}
+}
+
+TEST(TestPathValidator, cancelledValidationSkipsChecks) {
+	auto validator = extras::PathValidator{[](ArrayView<extras::PathStatus const>) -> Optional<Error> {
+			return none;
+		}};
+
+	const char* argv[] = {"prog", "/", "/"};
+	auto parser = Parser{"Test path validator"};
+	parser.arguments({
+		{"*", "Paths", validator.collector()}
+	});
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+
+	CancellationToken cancellation;
+	cancellation.cancel();
+	auto const results = validator.validate(cancellation);
+	ASSERT_EQ(2U, results.size());
+	EXPECT_EQ(ECANCELED, results[0].errorCode);
+	EXPECT_EQ(ECANCELED, results[1].errorCode);
+}
+
+
+TEST(TestPathValidator, reusedWithoutReset) {
+	std::vector<extras::PathStatus> reported;
+	auto validator = extras::PathValidator{[&reported](ArrayView<extras::PathStatus const> results) -> Optional<Error> {
+			reported.assign(results.begin(), results.end());
+			for (auto const& status : results) {
+				if (!status.isOk()) {
+					return makeParserError(ParserError::InvalidInput, status.path);
+				}
+			}
+
+			return none;
+		}};
+
+	auto parser = Parser{"Test path validator"};
+	parser.arguments({
+		{"*", "Paths", validator.collector()}
+	});
+
+	const char* argv[] = {"prog", "/", "/"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(2U, reported.size());
+
+	// Second parse is validated on its own
+	const char* missingArgv[] = {"prog", "/no/such/path"};
+	ASSERT_TRUE(parser.parse(arrayView(missingArgv)).isError());
+	EXPECT_EQ(1U, reported.size());
+	EXPECT_EQ(1U, validator.paths().size());
+
+	// Without deferred tasks each path is checked as it is parsed
+	reported.clear();
+	auto cntx = Parser::Context{arrayView(missingArgv), 1, "Paths", parser};
+	auto maybeError = validator.collector()(missingArgv[1], cntx);
+	ASSERT_TRUE(maybeError.isSome());
+	ASSERT_EQ(1U, reported.size());
+	EXPECT_EQ(ENOENT, reported[0].errorCode);
+}
+
+
+TEST(TestPathValidator, independentArgumentIsReportedOnce) {
+	int nbReports = 0;
+	std::vector<extras::PathStatus> reported;
+	auto validator = extras::PathValidator{
+			[&nbReports, &reported](ArrayView<extras::PathStatus const> results) -> Optional<Error> {
+				nbReports += 1;
+				reported.assign(results.begin(), results.end());
+				return none;
+			}};
+
+	std::vector<const char*> argv{"prog"};
+	for (int i = 0; i < 64; ++i) {
+		argv.push_back("/");
+	}
+
+	auto parser = Parser{"Test path validator"};
+	parser.concurrencyLimit(2)
+			.arguments({
+				Parser::Argument{"*", "Paths", validator.collector()}.independent()
+			});
+
+	ASSERT_TRUE(parser.parse(arrayView(argv.data(), argv.size())).isOk());
+	EXPECT_EQ(1, nbReports);
+	ASSERT_EQ(64U, reported.size());
+	for (extras::PathStatus::size_type i = 0; i < reported.size(); ++i) {
+		EXPECT_EQ(i + 1, reported[i].position);
+	}
+}
+
+
+TEST(TestPathValidator, cacheReplayIsReportedOnce) {
+	int nbReports = 0;
+	std::vector<extras::PathStatus> reported;
+	auto validator = extras::PathValidator{
+			[&nbReports, &reported](ArrayView<extras::PathStatus const> results) -> Optional<Error> {
+				nbReports += 1;
+				reported.assign(results.begin(), results.end());
+				return none;
+			}};
+
+	auto parser = Parser{"Test path validator"};
+	parser.arguments({
+		{"*", "Paths", validator.collector()}
+	});
+
+	auto cache = ParseCache{parser};
+	const char* argv[] = {"prog", "/", "/", "/"};
+	ASSERT_TRUE(cache.parse(arrayView(argv)).isOk());
+	ASSERT_TRUE(cache.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(1U, cache.stats().hits);
+
+	EXPECT_EQ(2, nbReports);
+	EXPECT_EQ(3U, reported.size());
+}
@@ -0,0 +1,90 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_pluginCommand.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/pluginCommand.hpp>  // Class being tested
+#include <clime/utils.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <dlfcn.h>
+
+#include <sstream>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::extras;
+
+
+TEST(TestPluginCommand, parseManifest) {
+	auto const manifest = StringView{
+		"# name  path  description\n"
+		"\n"
+		"deploy\t/usr/lib/tool/deploy.so\tDeploy a release  \r\n"
+		"  status  status.so\n"};
+
+	auto maybeEntries = parsePluginManifest(manifest);
+	ASSERT_TRUE(maybeEntries.isOk());
+
+	auto const& entries = maybeEntries.unwrap();
+	ASSERT_EQ(2U, entries.size());
+	EXPECT_EQ(StringView("deploy"), entries[0].name);
+	EXPECT_EQ(StringView("/usr/lib/tool/deploy.so"), entries[0].path);
+	EXPECT_EQ(StringView("Deploy a release"), entries[0].description);
+	EXPECT_EQ(StringView("status"), entries[1].name);
+	EXPECT_EQ(StringView("status.so"), entries[1].path);
+	EXPECT_TRUE(entries[1].description.empty());
+
+	auto malformed = parsePluginManifest("deploy\nstatus status.so");
+	ASSERT_TRUE(malformed.isError());
+	EXPECT_EQ(StringView("deploy"), malformed.getError().tag());
+}
+
+
+TEST(TestPluginCommand, loadedOnDispatch) {
+	auto const path = std::string{CLIME_TEST_PLUGIN};
+	auto const manifest = "plugin " + path + " Command from a plugin\n"
+						  "missing /nonexistent/plugin.so Missing plugin\n";
+
+	auto parser = Parser{"Plugins"};
+	for (auto const& entry : parsePluginManifest({manifest.data(), static_cast<uint32>(manifest.size())}).unwrap()) {
+		parser.addCommand(entry.name, pluginCommand(entry));
+	}
+
+	// Help is printed from the manifest
+	std::stringstream output;
+	HelpFormatter{}(output, "prog", parser.defaultAction());
+	EXPECT_NE(std::string::npos, output.str().find("Command from a plugin"));
+	EXPECT_EQ(nullptr, dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD));
+
+	char const* argv[] = {"prog", "plugin", "nested"};
+	auto maybeCommand = parser.resolve(arrayView(argv));
+	ASSERT_TRUE(maybeCommand.isOk());
+	EXPECT_EQ(StringView("Nested plugin command"), maybeCommand.unwrap()->description());
+	EXPECT_TRUE(maybeCommand.unwrap()->action()().isOk());
+
+	char const* missingArgv[] = {"prog", "missing"};
+	auto missing = parser.resolve(arrayView(missingArgv));
+	ASSERT_TRUE(missing.isError());
+	EXPECT_EQ(StringView("/nonexistent/plugin.so"), missing.getError().tag());
+}
@@ -0,0 +1,144 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/extras/test_reloadableSettings.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/extras/reloadableSettings.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+struct Settings {
+	int32 cacheSize{16};
+	int32 timeout{10};
+	int32 port{8080};
+};
+
+}  // namespace
+
+
+TEST(TestReloadableSettings, defaultSnapshotIsPublished) {
+	auto settings = extras::ReloadableSettings<Settings>{};
+	EXPECT_EQ(16, settings.current().cacheSize);
+	EXPECT_EQ(0U, settings.generation());
+}
+
+TEST(TestReloadableSettings, loadAppliesAllOptions) {
+	auto settings = extras::ReloadableSettings<Settings>{};
+	auto parser = Parser{"test_app", {
+			Parser::Option{{"cache"}, "Cache size", &settings.staging()->cacheSize}.reloadable(),
+			{{"port"}, "Port", &settings.staging()->port}
+		}};
+
+	const char* argv[] = {"prog", "--cache", "32", "--port", "9000"};
+	ASSERT_TRUE(settings.load(parser, arrayView(argv)).isOk());
+
+	EXPECT_EQ(32, settings.current().cacheSize);
+	EXPECT_EQ(9000, settings.current().port);
+	EXPECT_EQ(1U, settings.generation());
+}
+
+TEST(TestReloadableSettings, reloadIgnoresStartupOnlyOptions) {
+	auto settings = extras::ReloadableSettings<Settings>{};
+	auto parser = Parser{"test_app", {
+			Parser::Option{{"cache"}, "Cache size", &settings.staging()->cacheSize}.reloadable(),
+			{{"port"}, "Port", &settings.staging()->port}
+		}};
+
+	const char* argv[] = {"prog", "--cache", "32", "--port", "9000"};
+	ASSERT_TRUE(settings.load(parser, arrayView(argv)).isOk());
+
+	Settings const& initial = settings.current();
+
+	const char* reloadArgv[] = {"prog", "--cache", "64", "--port", "1234"};
+	ASSERT_TRUE(settings.reload(parser, arrayView(reloadArgv)).isOk());
+
+	EXPECT_EQ(64, settings.current().cacheSize);
+	EXPECT_EQ(9000, settings.current().port);
+
+	// Old snapshot is still valid until reclaimed
+	EXPECT_EQ(32, initial.cacheSize);
+	settings.reclaim();
+}
+
+TEST(TestReloadableSettings, failedValidationKeepsCurrentSnapshot) {
+	auto settings = extras::ReloadableSettings<Settings>{};
+	auto parser = Parser{"test_app", {
+			Parser::Option{{"timeout"}, "Timeout", &settings.staging()->timeout}.reloadable()
+		}};
+
+	auto validator = [](Settings const& s) -> Optional<Error> {
+		if (s.timeout <= 0) {
+			return makeParserError(ParserError::InvalidInput, "timeout");
+		}
+
+		return none;
+	};
+
+	const char* argv[] = {"prog", "--timeout=-1"};
+	EXPECT_TRUE(settings.reload(parser, arrayView(argv), validator).isError());
+	EXPECT_EQ(10, settings.current().timeout);
+	EXPECT_EQ(0U, settings.generation());
+
+	const char* invalidArgv[] = {"prog", "--timeout", "blah"};
+	EXPECT_TRUE(settings.reload(parser, arrayView(invalidArgv), validator).isError());
+	EXPECT_EQ(10, settings.current().timeout);
+}
+
+TEST(TestReloadableSettings, readersObserveConsistentSnapshots) {
+	auto settings = extras::ReloadableSettings<Settings>{};
+	auto parser = Parser{"test_app", {
+			Parser::Option{{"cache"}, "Cache size", &settings.staging()->cacheSize}.reloadable(),
+			Parser::Option{{"timeout"}, "Timeout", &settings.staging()->timeout}.reloadable()
+		}};
+
+	const char* argvA[] = {"prog", "--cache", "1", "--timeout", "1"};
+	const char* argvB[] = {"prog", "--cache", "2", "--timeout", "2"};
+	ASSERT_TRUE(settings.load(parser, arrayView(argvA)).isOk());
+
+	std::atomic<bool> done{false};
+	std::atomic<int> inconsistencies{0};
+	auto reader = std::thread{[&]() {
+		while (!done.load()) {
+			auto const& s = settings.current();
+			if (s.cacheSize != s.timeout) {
+				inconsistencies.fetch_add(1);
+			}
+		}
+	}};
+
+	for (int i = 0; i < 200; ++i) {
+		EXPECT_TRUE(settings.reload(parser, (i % 2) ? arrayView(argvA) : arrayView(argvB)).isOk());
+	}
+
+	done = true;
+	reader.join();
+
+	EXPECT_EQ(0, inconsistencies.load());
+	EXPECT_EQ(201U, settings.generation());
+}
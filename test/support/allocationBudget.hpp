@@ -0,0 +1,63 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/support/allocationBudget.hpp
+ * @brief: Allocation budget assertions for tests.
+*******************************************************************************/
+#pragma once
+#ifndef CLIME_TEST_SUPPORT_ALLOCATIONBUDGET_HPP
+#define CLIME_TEST_SUPPORT_ALLOCATIONBUDGET_HPP
+
+#include "allocations.hpp"
+
+#include <gtest/gtest.h>
+
+
+namespace clime::test {
+
+/// Maximum number and total size of heap allocations a scenario may make.
+struct AllocationBudget {
+	Solace::uint64	maxCount;
+	Solace::uint64	maxBytes;
+};
+
+
+/// Predicate-formatter checking allocations of a scope against a budget, @see EXPECT_ALLOCATIONS_WITHIN.
+inline ::testing::AssertionResult
+allocationsWithinBudget(char const* scopeExpr, char const* budgetExpr,
+						AllocationScope const& scope, AllocationBudget const& budget) {
+	auto const stats = scope.stats();
+	if (stats.count <= budget.maxCount && stats.bytes <= budget.maxBytes) {
+		return ::testing::AssertionSuccess();
+	}
+
+	return ::testing::AssertionFailure()
+			<< scopeExpr << " made " << stats.count << " allocations of " << stats.bytes << " bytes, "
+			<< "over " << budgetExpr << " of " << budget.maxCount << " allocations of " << budget.maxBytes << " bytes";
+}
+
+}  // End of namespace clime::test
+
+
+/// Check that allocations made in a scope so far are within a budget.
+#define EXPECT_ALLOCATIONS_WITHIN(scope, budget) \
+	EXPECT_PRED_FORMAT2(::clime::test::allocationsWithinBudget, scope, budget)
+
+#define ASSERT_ALLOCATIONS_WITHIN(scope, budget) \
+	ASSERT_PRED_FORMAT2(::clime::test::allocationsWithinBudget, scope, budget)
+
+#endif  // CLIME_TEST_SUPPORT_ALLOCATIONBUDGET_HPP
@@ -0,0 +1,123 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/support/allocations.cpp
+ * @brief: Counting hooks replacing the global allocation functions.
+*******************************************************************************/
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+#if defined(__SANITIZE_ADDRESS__)
+#define CLIME_COUNT_ALLOCATIONS 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define CLIME_COUNT_ALLOCATIONS 0
+#endif
+#endif
+
+#ifndef CLIME_COUNT_ALLOCATIONS
+#define CLIME_COUNT_ALLOCATIONS 1
+#endif
+
+
+using namespace Solace;
+using namespace clime::test;
+
+
+namespace /* anonymous */ {
+
+std::atomic<uint64> allocationCount{0};
+std::atomic<uint64> allocationBytes{0};
+
+
+void countAllocation(size_t size) noexcept {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocationBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+}  // anonymous namespace
+
+
+#if CLIME_COUNT_ALLOCATIONS
+
+#if defined(__GLIBC__)
+
+// Note: glibc exports its allocator under these names, so that it can be interposed
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* p, size_t size);
+
+void* malloc(size_t size) {
+	countAllocation(size);
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+	countAllocation(n * size);
+	return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size) {
+	countAllocation(size);
+	return __libc_realloc(p, size);
+}
+}  // extern "C"
+
+#define CLIME_RAW_MALLOC __libc_malloc
+#else
+#define CLIME_RAW_MALLOC std::malloc
+#endif
+
+
+// Other forms of new, such as new[] and nothrow new, call this one by default
+void* operator new(std::size_t size) {
+	countAllocation(size);
+
+	// Note: Raw malloc is called to count the allocation only once
+	if (auto p = CLIME_RAW_MALLOC(size ? size : 1)) {
+		return p;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+#endif  // CLIME_COUNT_ALLOCATIONS
+
+
+bool
+clime::test::isCountingAllocations() noexcept {
+	return CLIME_COUNT_ALLOCATIONS;
+}
+
+
+AllocationStats
+clime::test::allocationsSoFar() noexcept {
+	return {allocationCount.load(std::memory_order_relaxed), allocationBytes.load(std::memory_order_relaxed)};
+}
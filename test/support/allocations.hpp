@@ -0,0 +1,76 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/support/allocations.hpp
+ * @brief: Heap allocation counting, shared by tests and benchmarks.
+*******************************************************************************/
+#pragma once
+#ifndef CLIME_TEST_SUPPORT_ALLOCATIONS_HPP
+#define CLIME_TEST_SUPPORT_ALLOCATIONS_HPP
+
+#include <solace/types.hpp>
+
+
+namespace clime::test {
+
+/// Number and total size of heap allocations.
+struct AllocationStats {
+	Solace::uint64	count{0};
+	Solace::uint64	bytes{0};
+};
+
+
+/**
+ * Check if heap allocations are counted.
+ * Counting hooks replace `operator new` and, with glibc, `malloc`, `calloc` and `realloc`.
+ * They are disabled in builds with address sanitizer, which has to own the allocator itself.
+ */
+bool isCountingAllocations() noexcept;
+
+/// Allocations made by all threads of the process so far.
+AllocationStats allocationsSoFar() noexcept;
+
+
+/**
+ * RAII guard measuring allocations made while it is alive.
+ * Allocations are counted process-wide, so other threads must not allocate while a scope is measured,
+ * except for threads started by the code being measured.
+ */
+class AllocationScope {
+public:
+	AllocationScope() noexcept
+		: _start{allocationsSoFar()}
+	{}
+
+	AllocationScope(AllocationScope const&) = delete;
+	AllocationScope& operator= (AllocationScope const&) = delete;
+
+	/// Allocations made since the scope has been entered.
+	AllocationStats stats() const noexcept {
+		auto const now = allocationsSoFar();
+		return {now.count - _start.count, now.bytes - _start.bytes};
+	}
+
+	Solace::uint64 count() const noexcept { return stats().count; }
+	Solace::uint64 bytes() const noexcept { return stats().bytes; }
+
+private:
+	AllocationStats const	_start;
+};
+
+}  // End of namespace clime::test
+#endif  // CLIME_TEST_SUPPORT_ALLOCATIONS_HPP
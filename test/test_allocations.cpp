@@ -0,0 +1,162 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_allocations.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include "support/allocationBudget.hpp"
+
+#include <clime/parser.hpp>
+#include <clime/parseUtils.hpp>
+#include <clime/utils.hpp>
+#include <clime/extras/multivalueParser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace clime::test;
+
+
+/**
+ * Allocation budgets of startup paths.
+ * Budgets are tight on purpose: a change that allocates more must update them consciously.
+ */
+class TestAllocations : public ::testing::Test {
+public:
+
+	void SetUp() override {
+		if (!isCountingAllocations()) {
+			GTEST_SKIP() << "Allocations are not counted in this build";
+		}
+	}
+
+	static Result<void, Error> noop() {
+		return Ok();
+	}
+
+	bool	verbose{false};
+	uint16	port{0};
+	int32	retries{0};
+	StringView	host;
+};
+
+
+TEST_F(TestAllocations, scopeCountsAllocations) {
+	AllocationScope scope;
+	auto value = std::make_unique<uint64>(1);
+	EXPECT_EQ(1U, scope.count());
+	EXPECT_EQ(sizeof(uint64), scope.bytes());
+
+#if defined(__GLIBC__)
+	void* volatile block = std::malloc(100);
+	std::free(block);
+	EXPECT_EQ(2U, scope.count());
+	EXPECT_EQ(sizeof(uint64) + 100, scope.bytes());
+#endif
+
+	EXPECT_FALSE(allocationsWithinBudget("scope", "budget", scope, {1, 1000}));
+}
+
+
+TEST_F(TestAllocations, constructParser) {
+	AllocationScope scope;
+	auto parser = Parser{"Allocations", {
+		{{"v", "verbose"}, "Verbose output", &verbose},
+		{{"p", "port"}, "Port", &port},
+		{{"r", "retries"}, "Number of retries", &retries},
+		{{"H", "host"}, "Host", &host}
+	}};
+
+	EXPECT_ALLOCATIONS_WITHIN(scope, (AllocationBudget{9, 704}));
+}
+
+
+TEST_F(TestAllocations, parseSimpleFlags) {
+	auto parser = Parser{"Allocations", {
+		{{"v", "verbose"}, "Verbose output", &verbose},
+		{{"p", "port"}, "Port", &port},
+		{{"r", "retries"}, "Number of retries", &retries},
+		{{"H", "host"}, "Host", &host}
+	}};
+
+	char const* argv[] = {"prog", "-v", "--port=8080", "-r", "3", "--host", "example.com"};
+	AllocationScope scope;
+	auto result = parser.parse(arrayView(argv));
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_ALLOCATIONS_WITHIN(scope, (AllocationBudget{0, 0}));
+}
+
+
+TEST_F(TestAllocations, parseNestedCommands) {
+	auto parser = Parser{"Allocations", {
+		{{"v", "verbose"}, "Verbose output", &verbose}
+	}};
+	parser.addCommand("remote", "Manage remotes", noop)
+		.addCommand("add", "Add a remote", noop)
+			.options(Parser::Option{{"p", "port"}, "Port", &port},
+					 Parser::Option{{"H", "host"}, "Host", &host});
+
+	char const* argv[] = {"prog", "remote", "add", "--port=22", "-H", "example.com"};
+	AllocationScope scope;
+	auto result = parser.parse(arrayView(argv));
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_ALLOCATIONS_WITHIN(scope, (AllocationBudget{0, 0}));
+}
+
+
+TEST_F(TestAllocations, multivalueParser) {
+	auto parseValue = [](StringView value) { return tryParse<uint32>(value); };
+	auto ports = extras::MultivalueParser<uint32, decltype(parseValue)>{parseValue};
+	auto parser = Parser{"Allocations", {
+		{{"p", "ports"}, "Ports", Parser::ArgumentValue::Required, std::ref(ports)}
+	}};
+
+	char const* argv[] = {"prog", "--ports=80,443,8080", "-p", "22"};
+	AllocationScope scope;
+	auto result = parser.parse(arrayView(argv));
+
+	ASSERT_TRUE(result.isOk());
+	EXPECT_EQ(4U, ports.values.size());
+	EXPECT_ALLOCATIONS_WITHIN(scope, (AllocationBudget{4, 64}));
+}
+
+
+TEST_F(TestAllocations, helpFormatter) {
+	auto const command = Parser::Command{"Allocations", noop, {
+		{{"v", "verbose"}, "Verbose output", &verbose},
+		{{"p", "port"}, "Port", &port},
+		{{"r", "retries"}, "Number of retries", &retries},
+		{{"H", "host"}, "Host", &host}
+	}};
+
+	std::stringstream output;
+	AllocationScope scope;
+	HelpFormatter{}(output, "prog", command);
+
+	EXPECT_FALSE(output.str().empty());
+	EXPECT_ALLOCATIONS_WITHIN(scope, (AllocationBudget{2, 768}));
+}
@@ -0,0 +1,137 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_choices.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/choices.hpp>  // Class being tested
+#include <clime/parser.hpp>
+#include <clime/utils.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+enum class Mode {
+	Fast,
+	Safe,
+	Audit
+};
+
+constexpr auto kModes = makeChoices<Mode>({
+	{"fast", Mode::Fast},
+	{"safe", Mode::Safe},
+	{"audit", Mode::Audit}
+});
+
+static_assert(kModes.isPerfect(), "Small table must have a perfect hash");
+static_assert(kModes.indexOf("audit") == 2, "Lookup must work at compile time");
+static_assert(kModes.indexOf("slow") == kModes.size(), "Unknown names must not be found");
+
+}  // namespace
+
+
+TEST(TestChoices, lookupByName) {
+	EXPECT_EQ(Mode::Safe, kModes.find("safe").get());
+	EXPECT_TRUE(kModes.find("saf").isNone());
+	EXPECT_TRUE(kModes.find("safer").isNone());
+	EXPECT_TRUE(kModes.find("").isNone());
+}
+
+
+TEST(TestChoices, largeTableHasPerfectHash) {
+	constexpr auto codecs = makeChoices<int>({
+		{"aac", 0}, {"ac3", 1}, {"alac", 2}, {"amr", 3}, {"ape", 4}, {"av1", 5}, {"avs", 6}, {"dts", 7},
+		{"dv", 8}, {"eac3", 9}, {"flac", 10}, {"g722", 11}, {"g723", 12}, {"g726", 13}, {"g729", 14}, {"gsm", 15},
+		{"h261", 16}, {"h263", 17}, {"h264", 18}, {"hevc", 19}, {"ilbc", 20}, {"jpeg", 21}, {"mjpeg", 22}, {"mp2", 23},
+		{"mp3", 24}, {"mpeg1", 25}, {"mpeg2", 26}, {"mpeg4", 27}, {"opus", 28}, {"pcm", 29}, {"png", 30}, {"qdm2", 31},
+		{"ra", 32}, {"speex", 33}, {"theora", 34}, {"tta", 35}, {"vc1", 36}, {"vorbis", 37}, {"vp8", 38}, {"vp9", 39}
+	});
+
+	static_assert(codecs.isPerfect(), "Codec table must have a perfect hash");
+
+	for (ChoiceTable<int, 40>::size_type i = 0; i < codecs.size(); ++i) {
+		EXPECT_EQ(i, codecs.indexOf(codecs.name(i)));
+	}
+}
+
+
+TEST(TestChoices, duplicateNamesAreRejected) {
+	// Note: A constexpr table with duplicate names does not compile in debug builds
+	EXPECT_DEBUG_DEATH(makeChoices<Mode>({{"fast", Mode::Fast}, {"fast", Mode::Safe}}), "Duplicate choice name");
+}
+
+
+TEST(TestChoices, optionBindsEnum) {
+	Mode mode = Mode::Fast;
+	auto parser = Parser{"Choice test", {
+		{{"m", "mode"}, "Mode of operation", &mode, kModes}
+	}};
+
+	char const* argv[] = {"prog", "--mode=audit"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(Mode::Audit, mode);
+
+	char const* argvShort[] = {"prog", "-m", "safe"};
+	ASSERT_TRUE(parser.parse(arrayView(argvShort)).isOk());
+	EXPECT_EQ(Mode::Safe, mode);
+}
+
+
+TEST(TestChoices, invalidChoiceIsPositioned) {
+	Mode mode = Mode::Fast;
+	auto parser = Parser{"Choice test", {
+		{{"mode"}, "Mode of operation", &mode, kModes}
+	}};
+
+	char const* argv[] = {"prog", "--mode", "slow"};
+	auto result = parser.parse(arrayView(argv));
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(Mode::Fast, mode);
+
+	auto const info = parserErrorInfo(result.getError());
+	EXPECT_EQ(ParserError::UnexpectedValue, info.code);
+	EXPECT_EQ(ValueKind::Choice, info.expected);
+	EXPECT_EQ(2U, info.argvIndex);
+	EXPECT_EQ(StringView("slow"), info.token);
+
+	char buffer[128];
+	formatParserError(result.getError(), buffer, sizeof(buffer));
+	EXPECT_EQ(std::string("argv[2] 'slow': unexpected value (choice)"), std::string(buffer));
+}
+
+
+TEST(TestChoices, helpListsChoices) {
+	Mode mode = Mode::Fast;
+	auto const command = Parser::Command{"Choice test", []() -> Result<void, Error> { return Ok(); }, {
+		{{"mode"}, "Mode of operation", &mode, kModes}
+	}};
+
+	std::stringstream output;
+	HelpFormatter{}(output, "prog", command);
+	EXPECT_NE(std::string::npos, output.str().find("Mode of operation {fast|safe|audit}"));
+}
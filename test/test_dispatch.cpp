@@ -0,0 +1,158 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_dispatch.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/parser.hpp>  // Class being tested
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <thread>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+/// Executor that queues tasks until explicitly run.
+struct QueueExecutor final : public Executor {
+	void post(Task task) override {
+		tasks.emplace_back(mv(task));
+	}
+
+	void runAll() {
+		while (!tasks.empty()) {
+			auto task = mv(tasks.front());
+			tasks.pop_front();
+			task();
+		}
+	}
+
+	std::deque<Task> tasks;
+};
+
+}  // namespace
+
+
+class TestDispatch: public ::testing::Test {
+public:
+
+	TestDispatch()
+		: parser{"Test dispatch"}
+	{
+		parser.commands({
+			{"sync", {"Synchronous action", [this]() -> Result<void, Error> {
+					syncCalls += 1;
+					return Ok();
+				}}},
+			{"async", {"Asynchronous action",
+				[](Executor&, CancellationToken const&, Completion completion) {
+					// Complete from another thread, as an IO-bound action would
+					std::thread{[done = mv(completion)]() { done(Ok()); }}.detach();
+				}}},
+			{"fetch", {"Action using the executor",
+				[this](Executor& executor, CancellationToken const& cancellation, Completion completion) {
+					executor.post([this, cancellation, done = mv(completion)]() {
+						if (cancellation.isCancelled()) {
+							done(makeParserError(ParserError::Cancelled, "fetch"));
+							return;
+						}
+
+						asyncCalls += 1;
+						done(Ok());
+					});
+				}}}
+		});
+	}
+
+	int syncCalls{0};
+	int asyncCalls{0};
+	Parser parser;
+};
+
+
+TEST_F(TestDispatch, syncActionRunsOnExecutor) {
+	QueueExecutor executor;
+	Optional<bool> completed;
+
+	char const* argv[] = {"prog", "sync"};
+	parser.dispatch(arrayView(argv), executor, [&completed](Result<void, Error> result) {
+		completed = result.isOk();
+	});
+
+	EXPECT_FALSE(completed.isSome());
+	EXPECT_EQ(0, syncCalls);
+
+	executor.runAll();
+	ASSERT_TRUE(completed.isSome());
+	EXPECT_TRUE(completed.get());
+	EXPECT_EQ(1, syncCalls);
+}
+
+TEST_F(TestDispatch, asyncActionCanBeParsedAsBlocking) {
+	ASSERT_TRUE(parser.defaultAction().commands().at("async").isAsync());
+	ASSERT_FALSE(parser.defaultAction().commands().at("sync").isAsync());
+
+	char const* argv[] = {"prog", "async"};
+	auto result = parser.parse(arrayView(argv));
+	ASSERT_TRUE(result.isOk());
+	EXPECT_TRUE(result.unwrap()().isOk());
+
+	char const* argvFetch[] = {"prog", "fetch"};
+	auto fetch = parser.parse(arrayView(argvFetch));
+	ASSERT_TRUE(fetch.isOk());
+	EXPECT_TRUE(fetch.unwrap()().isOk());
+	EXPECT_EQ(1, asyncCalls);
+}
+
+TEST_F(TestDispatch, cancelledActionCompletesWithError) {
+	QueueExecutor executor;
+	CancellationToken cancellation;
+	Optional<Error> error;
+
+	char const* argv[] = {"prog", "fetch"};
+	parser.dispatch(arrayView(argv), executor, [&error](Result<void, Error> result) {
+		if (!result) {
+			error = result.moveError();
+		}
+	}, cancellation);
+
+	cancellation.cancel();
+	executor.runAll();
+
+	ASSERT_TRUE(error.isSome());
+	EXPECT_EQ(static_cast<int>(ParserError::Cancelled), error.get().value());
+	EXPECT_EQ(0, asyncCalls);
+}
+
+TEST_F(TestDispatch, parseErrorIsReportedToCompletion) {
+	InlineExecutor executor;
+	bool failed = false;
+
+	char const* argv[] = {"prog", "unknown"};
+	parser.dispatch(arrayView(argv), executor, [&failed](Result<void, Error> result) {
+		failed = result.isError();
+	});
+
+	EXPECT_TRUE(failed);
+}
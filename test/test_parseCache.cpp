@@ -0,0 +1,161 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_parseCache.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/parseCache.hpp>  // Class being tested
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+class TestParseCache: public ::testing::Test {
+public:
+
+	TestParseCache()
+		: parser{"Test cache", {
+				{{"v", "verbose"}, "Verbose output", &verbose},
+				{{"s", "size"}, "Size", &size},
+				{{"r", "ratio"}, "Ratio", &ratio},
+				{{"t", "tag"}, "Tag", Parser::ArgumentValue::Required,
+					[this](Optional<StringView> const& value, Parser::Context const&) -> Optional<Error> {
+						tags.append(value.get().data(), value.get().size());
+						return none;
+					}}
+			}}
+	{
+		parser.commands({
+			{"status", {"Query status", {{"target", "Status target", &target}}, []() -> Result<void, Error> {
+					return Ok();
+				}}},
+			{"health", {"Health check", []() -> Result<void, Error> {
+					return Ok();
+				}}}
+		});
+	}
+
+	void resetBindings() {
+		verbose = false;
+		size = 0;
+		ratio = 0;
+		target = {};
+	}
+
+	bool verbose{false};
+	int32 size{0};
+	float64 ratio{0};
+	StringView target;
+	std::string tags;
+	Parser parser;
+};
+
+
+TEST_F(TestParseCache, hitReplaysBoundValues) {
+	auto cache = ParseCache{parser};
+
+	char const* argv[] = {"prog", "-v", "--size=42", "-r", "0.5", "status", "db"};
+	ASSERT_TRUE(cache.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(1U, cache.stats().misses);
+	EXPECT_EQ(1U, cache.stats().entries);
+
+	resetBindings();
+
+	// Identical command line in a different buffer
+	std::string tokens[] = {"prog", "-v", "--size=42", "-r", "0.5", "status", "db"};
+	char const* argvCopy[] = {tokens[0].c_str(), tokens[1].c_str(), tokens[2].c_str(), tokens[3].c_str(),
+							  tokens[4].c_str(), tokens[5].c_str(), tokens[6].c_str()};
+	auto result = cache.parse(arrayView(argvCopy));
+	ASSERT_TRUE(result.isOk());
+	EXPECT_TRUE(result.unwrap()().isOk());
+
+	EXPECT_EQ(1U, cache.stats().hits);
+	EXPECT_TRUE(verbose);
+	EXPECT_EQ(42, size);
+	EXPECT_DOUBLE_EQ(0.5, ratio);
+	EXPECT_EQ(StringView("db"), target);
+	EXPECT_EQ(tokens[6].c_str(), target.data());
+	EXPECT_DOUBLE_EQ(0.5, cache.stats().hitRate());
+}
+
+TEST_F(TestParseCache, customCallbacksAreCalledOnReplay) {
+	auto cache = ParseCache{parser};
+
+	char const* argv[] = {"prog", "-t", "a", "--tag=b", "health"};
+	ASSERT_TRUE(cache.parse(arrayView(argv)).isOk());
+	ASSERT_TRUE(cache.parse(arrayView(argv)).isOk());
+
+	EXPECT_EQ(1U, cache.stats().hits);
+	EXPECT_EQ("abab", tags);
+}
+
+TEST_F(TestParseCache, errorsAndNonCacheableOptionsAreNotCached) {
+	parser.options({
+		{{"s", "size"}, "Size", &size},
+		Parser::Option{{"once"}, "Side effect", Parser::ArgumentValue::NotRequired,
+			[this](Optional<StringView> const&, Parser::Context const&) -> Optional<Error> {
+				tags += "!";
+				return none;
+			}}.cacheable(false)
+	});
+
+	auto cache = ParseCache{parser};
+
+	char const* argvInvalid[] = {"prog", "--size", "not-a-number", "health"};
+	EXPECT_TRUE(cache.parse(arrayView(argvInvalid)).isError());
+	EXPECT_TRUE(cache.parse(arrayView(argvInvalid)).isError());
+
+	char const* argvSideEffect[] = {"prog", "--once", "health"};
+	EXPECT_TRUE(cache.parse(arrayView(argvSideEffect)).isOk());
+	EXPECT_TRUE(cache.parse(arrayView(argvSideEffect)).isOk());
+
+	EXPECT_EQ(0U, cache.stats().hits);
+	EXPECT_EQ(4U, cache.stats().uncacheable);
+	EXPECT_EQ(0U, cache.stats().entries);
+	EXPECT_EQ("!!", tags);
+}
+
+TEST_F(TestParseCache, leastRecentlyUsedEntryIsEvicted) {
+	auto cache = ParseCache{parser, 2};
+
+	char const* argv1[] = {"prog", "-s", "1", "health"};
+	char const* argv2[] = {"prog", "-s", "2", "health"};
+	char const* argv3[] = {"prog", "-s", "3", "health"};
+	ASSERT_TRUE(cache.parse(arrayView(argv1)).isOk());
+	ASSERT_TRUE(cache.parse(arrayView(argv2)).isOk());
+	ASSERT_TRUE(cache.parse(arrayView(argv1)).isOk());  // argv2 is now least recently used
+	ASSERT_TRUE(cache.parse(arrayView(argv3)).isOk());
+
+	EXPECT_EQ(2U, cache.stats().entries);
+	EXPECT_EQ(1U, cache.stats().evictions);
+
+	ASSERT_TRUE(cache.parse(arrayView(argv1)).isOk());
+	EXPECT_EQ(1, size);
+	EXPECT_EQ(2U, cache.stats().hits);
+
+	ASSERT_TRUE(cache.parse(arrayView(argv2)).isOk());
+	EXPECT_EQ(2, size);
+	EXPECT_EQ(2U, cache.stats().hits);
+	EXPECT_LE(cache.stats().memoryUsed, ParseCache::kDefaultMaxMemory);
+}
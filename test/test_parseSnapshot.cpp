@@ -0,0 +1,116 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_parseSnapshot.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/parseSnapshot.hpp>  // Class being tested
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+namespace {
+
+struct Settings {
+	bool		verbose{false};
+	int32		workers{0};
+	StringView	listen;
+	StringView	config;
+	int			nbCalls{0};
+};
+
+
+Parser makeParser(Settings& settings, StringLiteral workersName = "workers") {
+	auto parser = Parser{"Supervisor"};
+	parser.options(Parser::Option{{"v", "verbose"}, "Verbose", &settings.verbose},
+				   Parser::Option{{workersName}, "Number of workers", &settings.workers},
+				   Parser::Option{{"trace"}, "Trace", Parser::ArgumentValue::NotRequired,
+						[&settings](Optional<StringView> const&, Parser::Context const&) -> Optional<Error> {
+							settings.nbCalls += 1;
+							return none;
+						}});
+
+	parser.addCommand("serve", "Serve requests", []() -> Result<void, Error> { return Ok(); })
+			.options(Parser::Option{{"listen"}, "Address to listen on", &settings.listen})
+			.arguments(Parser::Argument{"config", "Configuration", &settings.config});
+
+	return parser;
+}
+
+}  // namespace
+
+
+TEST(TestParseSnapshot, rebindIntoAnotherParser) {
+	Settings original;
+	auto parser = makeParser(original);
+
+	char const* argv[] = {"supervisor", "-v", "--workers=8", "--trace", "serve", "--listen", "tcp:*:80", "site.conf"};
+	ParseTrace trace;
+	ASSERT_TRUE(parser.parse(arrayView(argv), trace, nullptr).isOk());
+
+	auto maybeSnapshot = ParseSnapshot::capture(parser, arrayView(argv), trace);
+	ASSERT_TRUE(maybeSnapshot.isOk());
+	auto data = std::string{maybeSnapshot.unwrap().view().data(), maybeSnapshot.unwrap().size()};
+
+	// Snapshot stores no pointers: it can be rebound into different variables
+	Settings rebound;
+	auto child = makeParser(rebound);
+	StringArena arena;
+	auto maybeAction = ParseSnapshot::rebind(child, {data.data(), static_cast<uint32>(data.size())}, &arena);
+	ASSERT_TRUE(maybeAction.isOk());
+	EXPECT_TRUE(maybeAction.unwrap()().isOk());
+
+	EXPECT_TRUE(rebound.verbose);
+	EXPECT_EQ(8, rebound.workers);
+	EXPECT_EQ(1, rebound.nbCalls);
+	EXPECT_EQ(StringView("tcp:*:80"), rebound.listen);
+
+	// String values have been copied into the arena
+	data.assign(data.size(), '\0');
+	EXPECT_EQ(StringView("site.conf"), rebound.config);
+}
+
+
+TEST(TestParseSnapshot, rejectsMismatchedSchemaAndMalformedData) {
+	Settings settings;
+	auto parser = makeParser(settings);
+
+	char const* argv[] = {"supervisor", "--workers=8", "serve", "site.conf"};
+	ParseTrace trace;
+	ASSERT_TRUE(parser.parse(arrayView(argv), trace, nullptr).isOk());
+	auto snapshot = ParseSnapshot::capture(parser, arrayView(argv), trace).unwrap();
+
+	Settings other;
+	auto changed = makeParser(other, "threads");
+	auto mismatch = ParseSnapshot::rebind(changed, snapshot.view());
+	ASSERT_TRUE(mismatch.isError());
+	EXPECT_EQ(StringView("snapshot schema"), mismatch.getError().tag());
+	EXPECT_EQ(0, other.workers);
+
+	auto const view = snapshot.view();
+	EXPECT_TRUE(ParseSnapshot::rebind(parser, view.substring(0, view.size() - 1)).isError());
+	EXPECT_TRUE(ParseSnapshot::rebind(parser, view.substring(1)).isError());
+	EXPECT_TRUE(ParseSnapshot::rebind(parser, {}).isError());
+}
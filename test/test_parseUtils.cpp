@@ -0,0 +1,153 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_parseUtils.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/parseUtils.hpp>  // Functions being tested
+#include <clime/parser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <ctime>
+#include <random>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+using namespace std::chrono_literals;
+
+
+TEST(TestParseUtils, duration) {
+	EXPECT_EQ(250ms, tryParseDuration("250ms").unwrap());
+	EXPECT_EQ(1500ms, tryParseDuration("1.5s").unwrap());
+	EXPECT_EQ(90min, tryParseDuration("1h30m").unwrap());
+	EXPECT_EQ(36h, tryParseDuration("1.5d").unwrap());
+	EXPECT_EQ(0ns, tryParseDuration("0").unwrap());
+	EXPECT_EQ(1ns, tryParseDuration("0.001us").unwrap());
+
+	EXPECT_TRUE(tryParseDuration("").isError());
+	EXPECT_TRUE(tryParseDuration("250").isError());
+	EXPECT_TRUE(tryParseDuration("ms").isError());
+	EXPECT_TRUE(tryParseDuration("1.s").isError());
+	EXPECT_TRUE(tryParseDuration("1h30").isError());
+	EXPECT_TRUE(tryParseDuration("1.5ns").isError());
+	EXPECT_TRUE(tryParseDuration("10yr").isError());
+	EXPECT_TRUE(tryParseDuration("-1s").isError());
+	EXPECT_TRUE(tryParseDuration("106752d").isError());
+	EXPECT_TRUE(tryParseDuration("99999999999999999999ns").isError());
+
+	EXPECT_EQ(2s, tryParse<std::chrono::seconds>("2000ms").unwrap());
+	EXPECT_TRUE(tryParse<std::chrono::seconds>("1500ms").isError());
+}
+
+
+TEST(TestParseUtils, byteSize) {
+	EXPECT_EQ(ByteSize{4096}, tryParseByteSize("4096").unwrap());
+	EXPECT_EQ(ByteSize{512}, tryParseByteSize("512B").unwrap());
+	EXPECT_EQ(ByteSize{64ULL << 30}, tryParseByteSize("64GiB").unwrap());
+	EXPECT_EQ(ByteSize{64ULL << 30}, tryParseByteSize("64G").unwrap());
+	EXPECT_EQ(ByteSize{1500000}, tryParseByteSize("1.5MB").unwrap());
+	EXPECT_EQ(ByteSize{3ULL << 59}, tryParseByteSize("1.5EiB").unwrap());
+	EXPECT_EQ(ByteSize{~0ULL}, tryParseByteSize("18446744073709551615").unwrap());
+
+	EXPECT_TRUE(tryParseByteSize("").isError());
+	EXPECT_TRUE(tryParseByteSize("GiB").isError());
+	EXPECT_TRUE(tryParseByteSize("1.5").isError());
+	EXPECT_TRUE(tryParseByteSize("64gib").isError());
+	EXPECT_TRUE(tryParseByteSize("64GiB ").isError());
+	EXPECT_TRUE(tryParseByteSize("16EiB").isError());
+	EXPECT_TRUE(tryParseByteSize("18446744073709551616").isError());
+}
+
+
+TEST(TestParseUtils, timestamp) {
+	EXPECT_EQ(UtcTimestamp{1790812800s}, tryParseTimestamp("2026-10-01T00:00:00Z").unwrap());
+	EXPECT_EQ(UtcTimestamp{1790812800s}, tryParseTimestamp("2026-10-01").unwrap());
+	EXPECT_EQ(UtcTimestamp{1790812800s + 250ms}, tryParseTimestamp("2026-10-01 02:00:00.25+02:00").unwrap());
+	EXPECT_EQ(UtcTimestamp{-86400s}, tryParseTimestamp("1969-12-31T00:00:00z").unwrap());
+	EXPECT_EQ(UtcTimestamp{951782400s}, tryParseTimestamp("2000-02-29T00:00:00Z").unwrap());
+
+	EXPECT_TRUE(tryParseTimestamp("").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-10-01T00:00:00").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-10-01T24:00:00Z").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-13-01T00:00:00Z").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-02-29").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-10-01T00:00:00.Z").isError());
+	EXPECT_TRUE(tryParseTimestamp("2026-10-01T00:00:00Zz").isError());
+	EXPECT_TRUE(tryParseTimestamp("2300-01-01T00:00:00Z").isError());
+}
+
+
+TEST(TestParseUtils, fuzzRoundTrip) {
+	std::mt19937_64 random{20261001};
+
+	for (int i = 0; i < 10000; ++i) {
+		// Duration in nanoseconds written out as a sum of all units
+		auto const nanos = static_cast<int64>(random() >> 1);
+		auto rest = nanos;
+		std::string duration;
+		for (auto unit : {std::make_pair(86400000000000LL, "d"), std::make_pair(3600000000000LL, "h"),
+						  std::make_pair(60000000000LL, "m"), std::make_pair(1000000000LL, "s"),
+						  std::make_pair(1000000LL, "ms"), std::make_pair(1000LL, "us"), std::make_pair(1LL, "ns")}) {
+			duration += std::to_string(rest / unit.first) + unit.second;
+			rest %= unit.first;
+		}
+		ASSERT_EQ(std::chrono::nanoseconds{nanos}, tryParseDuration(duration.c_str()).unwrap()) << duration;
+
+		// Byte size with a random unit
+		auto const shift = static_cast<int>(random() % 7);
+		auto const bytes = random() >> (shift * 10);
+		auto const sizeString = std::to_string(bytes) + (shift == 0 ? "" : std::string{"KMGTPE"[shift - 1]} + "iB");
+		ASSERT_EQ(ByteSize{bytes << (shift * 10)}, tryParseByteSize(sizeString.c_str()).unwrap()) << sizeString;
+
+		// Timestamp formatted by the C library
+		auto const seconds = static_cast<std::time_t>(static_cast<int64>(random() % 14000000000ULL) - 7000000000LL);
+		auto const fraction = static_cast<int64>(random() % 1000000000);
+		std::tm tm{};
+		gmtime_r(&seconds, &tm);
+		char buffer[64];
+		auto const length = strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+		snprintf(buffer + length, sizeof(buffer) - length, ".%09lldZ", static_cast<long long>(fraction));
+		ASSERT_EQ(UtcTimestamp{std::chrono::seconds{seconds} + std::chrono::nanoseconds{fraction}},
+				  tryParseTimestamp(buffer).unwrap()) << buffer;
+	}
+}
+
+
+TEST(TestParseUtils, optionBindings) {
+	std::chrono::milliseconds flushInterval{0};
+	ByteSize cache{0};
+	UtcTimestamp since{};
+	auto parser = Parser{"Units test", {
+		{{"flush-interval"}, "Flush interval", &flushInterval},
+		{{"cache"}, "Cache size", &cache},
+		{{"since"}, "Start time", &since}
+	}};
+
+	char const* argv[] = {"prog", "--flush-interval=250ms", "--cache=64GiB", "--since=2026-10-01T00:00:00Z"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(250ms, flushInterval);
+	EXPECT_EQ(ByteSize{64ULL << 30}, cache);
+	EXPECT_EQ(UtcTimestamp{1790812800s}, since);
+
+	char const* badArgv[] = {"prog", "--flush-interval=250us"};
+	EXPECT_TRUE(parser.parse(arrayView(badArgv)).isError());
+}
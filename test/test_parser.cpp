@@ -19,13 +19,27 @@
  * @author: abbyssoul
 *******************************************************************************/
 #include <clime/parser.hpp>  // Class being tested
+#include <clime/diagnostics.hpp>
 #include <clime/parseUtils.hpp>
+#include <clime/threadPool.hpp>
+#include <clime/utils.hpp>
 
 #include <solace/posixErrorDomain.hpp>
 #include <solace/output_utils.hpp>
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
 
 using namespace Solace;
 using namespace clime;
@@ -859,6 +873,238 @@ TEST_F(TestCommandlineParser, testTrailingArgumentsWithOptions) {
     EXPECT_EQ(StringView("maybe_not"), lastTrailingArg);
 }
 
+TEST_F(TestCommandlineParser, testIndependentTrailingArguments) {
+    std::atomic<int> sum{0};
+
+    std::vector<std::string> values;
+    std::vector<const char*> argv{"prog"};
+    for (int i = 1; i <= 100; ++i) {
+        values.emplace_back(std::to_string(i));
+    }
+    for (auto const& value : values) {
+        argv.push_back(value.c_str());
+    }
+
+    auto parser = Parser("Something awesome");
+    parser.concurrencyLimit(4)
+            .arguments({
+                Parser::Argument{"*", "Input", [&sum](StringView v, const Parser::Context&) -> Optional<Error> {
+                    sum += tryParse<int32>(v).unwrap();
+                    return none;
+                }}.independent()
+            });
+
+    EXPECT_TRUE(parser.parse(arrayView(argv.data(), argv.size())).isOk());
+    EXPECT_EQ(5050, sum.load());
+
+    // Sequential fallback
+    sum = 0;
+    parser.concurrencyLimit(1);
+    EXPECT_TRUE(parser.parse(arrayView(argv.data(), argv.size())).isOk());
+    EXPECT_EQ(5050, sum.load());
+}
+
+TEST_F(TestCommandlineParser, testIndependentTrailingArgumentsReportFirstError) {
+    std::vector<std::string> values;
+    std::vector<const char*> argv{"prog"};
+    for (int i = 1; i <= 200; ++i) {
+        values.emplace_back(std::to_string(i));
+    }
+    for (auto const& value : values) {
+        argv.push_back(value.c_str());
+    }
+
+    auto parser = Parser("Something awesome");
+    parser.concurrencyLimit(8)
+            .arguments({
+                Parser::Argument{"*", "Input", [](StringView v, const Parser::Context&) -> Optional<Error> {
+                    if (v == StringView("57")) {
+                        return makeParserError(ParserError::OptionParsing, "first");
+                    }
+                    if (v == StringView("150")) {
+                        return makeParserError(ParserError::InvalidInput, "second");
+                    }
+
+                    return none;
+                }}.independent()
+            });
+
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        auto result = parser.parse(arrayView(argv.data(), argv.size()));
+        ASSERT_TRUE(result.isError());
+        EXPECT_EQ(static_cast<int>(ParserError::OptionParsing), result.getError().value());
+    }
+}
+
+TEST_F(TestCommandlineParser, testIndependentTrailingArgumentExceptionReachesCaller) {
+    std::vector<std::string> values;
+    std::vector<const char*> argv{"prog"};
+    for (int i = 1; i <= 100; ++i) {
+        values.emplace_back(std::to_string(i));
+    }
+    for (auto const& value : values) {
+        argv.push_back(value.c_str());
+    }
+
+    auto parser = Parser("Something awesome");
+    parser.concurrencyLimit(4)
+            .arguments({
+                Parser::Argument{"*", "Input", [](StringView v, const Parser::Context&) -> Optional<Error> {
+                    if (v == StringView("42")) {
+                        throw std::runtime_error{"bad input"};
+                    }
+
+                    return none;
+                }}.independent()
+            });
+
+    EXPECT_THROW(parser.parse(arrayView(argv.data(), argv.size())), std::runtime_error);
+}
+
+TEST_F(TestCommandlineParser, testDeferredOptionsRunConcurrently) {
+    std::atomic<int> started{0};
+    auto waitForOthers = [&started](CancellationToken const&) -> Result<void, Error> {
+        started += 1;
+        // Each task waits for the other one to start: serial execution would time out
+        for (int i = 0; i < 2000 && started.load() < 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return (started.load() < 2)
+                ? Result<void, Error>{makeParserError(ParserError::InvalidInput, "timeout")}
+                : Result<void, Error>{Ok()};
+    };
+
+    auto load = [&waitForOthers](Optional<StringView> const&, Parser::Context const&)
+            -> Result<Parser::DeferredTask, Error> {
+        return Ok(Parser::DeferredTask{waitForOthers});
+    };
+
+    const char* argv[] = {"prog", "--model=m.bin", "--dict", "words.txt", nullptr};
+    auto const result = Parser("Something awesome")
+            .options({
+                Parser::Option::deferred({"model"}, "Model to load", Parser::ArgumentValue::Required, load),
+                Parser::Option::deferred({"dict"}, "Dictionary to load", Parser::ArgumentValue::Required, load)
+            })
+            .concurrencyLimit(2)
+            .parse(countArgc(argv), argv);
+
+    EXPECT_TRUE(result.isOk());
+    EXPECT_EQ(2, started.load());
+}
+
+TEST_F(TestCommandlineParser, testDeferredOptionFailureCancelsOthers) {
+    bool wasCancelled = false;
+
+    const char* argv[] = {"prog", "--slow", "--broken", nullptr};
+    auto const result = Parser("Something awesome")
+            .options({
+                Parser::Option::deferred({"slow"}, "Slow load", Parser::ArgumentValue::NotRequired,
+                    [&wasCancelled](Optional<StringView> const&, Parser::Context const&)
+                            -> Result<Parser::DeferredTask, Error> {
+                        return Ok(Parser::DeferredTask{
+                            [&wasCancelled](CancellationToken const& cancellation) -> Result<void, Error> {
+                                for (int i = 0; i < 2000 && !cancellation.isCancelled(); ++i) {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                }
+
+                                wasCancelled = cancellation.isCancelled();
+                                return makeParserError(ParserError::Cancelled, "slow");
+                            }});
+                    }),
+                Parser::Option::deferred({"broken"}, "Failing load", Parser::ArgumentValue::NotRequired,
+                    [](Optional<StringView> const&, Parser::Context const&) -> Result<Parser::DeferredTask, Error> {
+                        return Ok(Parser::DeferredTask{[](CancellationToken const&) -> Result<void, Error> {
+                                return makeParserError(ParserError::InvalidInput, "broken");
+                            }});
+                    })
+            })
+            .concurrencyLimit(2)
+            .parse(countArgc(argv), argv);
+
+    ASSERT_TRUE(result.isError());
+    EXPECT_EQ(static_cast<int>(ParserError::InvalidInput), result.getError().value());
+    EXPECT_TRUE(wasCancelled);
+}
+
+TEST_F(TestCommandlineParser, testDeferredTasksCappedByConcurrencyLimit) {
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    auto load = [&](Optional<StringView> const&, Parser::Context const&) -> Result<Parser::DeferredTask, Error> {
+        return Ok(Parser::DeferredTask{[&](CancellationToken const&) -> Result<void, Error> {
+            auto const nowRunning = ++running;
+            auto seen = maxRunning.load();
+            while (seen < nowRunning && !maxRunning.compare_exchange_weak(seen, nowRunning)) {
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            --running;
+            return Ok();
+        }});
+    };
+
+    const char* argv[] = {"prog", "--a", "--b", "--c", "--d", nullptr};
+    auto const result = Parser("Something awesome")
+            .options({
+                Parser::Option::deferred({"a"}, "Load a", Parser::ArgumentValue::NotRequired, load),
+                Parser::Option::deferred({"b"}, "Load b", Parser::ArgumentValue::NotRequired, load),
+                Parser::Option::deferred({"c"}, "Load c", Parser::ArgumentValue::NotRequired, load),
+                Parser::Option::deferred({"d"}, "Load d", Parser::ArgumentValue::NotRequired, load)
+            })
+            .concurrencyLimit(2)
+            .parse(countArgc(argv), argv);
+
+    EXPECT_TRUE(result.isOk());
+    EXPECT_LE(maxRunning.load(), 2);
+}
+
+TEST_F(TestCommandlineParser, testDeferredTasksReuseSharedPool) {
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    auto load = [&](Optional<StringView> const&, Parser::Context const&) -> Result<Parser::DeferredTask, Error> {
+        return Ok(Parser::DeferredTask{[&](CancellationToken const&) -> Result<void, Error> {
+            std::lock_guard<std::mutex> guard{lock};
+            threads.insert(std::this_thread::get_id());
+            return Ok();
+        }});
+    };
+
+    auto parser = Parser("Something awesome");
+    parser.options({
+                Parser::Option::deferred({"a"}, "Load a", Parser::ArgumentValue::NotRequired, load),
+                Parser::Option::deferred({"b"}, "Load b", Parser::ArgumentValue::NotRequired, load)
+            })
+            .concurrencyLimit(2);
+
+    const char* argv[] = {"prog", "--a", "--b", nullptr};
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(parser.parse(countArgc(argv), argv).isOk());
+    }
+
+    // Tasks only ever run on the calling thread and the workers of the shared pool
+    threads.erase(std::this_thread::get_id());
+    EXPECT_LE(threads.size(), ThreadPool::shared().size());
+}
+
+TEST_F(TestCommandlineParser, testDeferredTaskExceptionIsError) {
+    auto load = [](Optional<StringView> const&, Parser::Context const&) -> Result<Parser::DeferredTask, Error> {
+        return Ok(Parser::DeferredTask{[](CancellationToken const&) -> Result<void, Error> {
+            throw std::runtime_error{"load failed"};
+        }});
+    };
+
+    const char* argv[] = {"prog", "--model", "--dict", nullptr};
+    auto const result = Parser("Something awesome")
+            .options({
+                Parser::Option::deferred({"model"}, "Model to load", Parser::ArgumentValue::NotRequired, load),
+                Parser::Option::deferred({"dict"}, "Dictionary to load", Parser::ArgumentValue::NotRequired, load)
+            })
+            .parse(countArgc(argv), argv);
+
+    ASSERT_TRUE(result.isError());
+    EXPECT_EQ(static_cast<int>(ParserError::OptionParsing), result.getError().value());
+}
+
 TEST_F(TestCommandlineParser, testCommandGivenButNotExpected) {
     bool commandExecuted = false;
     bool givenOpt = false;
@@ -1181,3 +1427,378 @@ TEST_F(TestCommandlineParser, multipleCommandWithOptionsAndArguments) {
     EXPECT_EQ(StringView("ArgValue1"), cmd2Options.arg1);
     EXPECT_EQ(StringView("arg2"), cmd2Options.arg2);
 }
+
+
+namespace {
+
+struct Endpoint {
+	std::string	host;
+	uint16		port;
+};
+
+}  // namespace
+
+
+namespace clime {
+
+template<>
+struct ValueParser<Endpoint> {
+	static Result<Endpoint, Error> parse(StringView value) {
+		for (StringView::size_type i = value.size(); i > 0; --i) {
+			if (value[i - 1] == ':') {
+				auto port = tryParse<uint16>(value.substring(i));
+				if (!port) {
+					return port.moveError();
+				}
+
+				return Ok(Endpoint{std::string{value.data(), i - 1}, port.unwrap()});
+			}
+		}
+
+		return makeParserError(ParserError::InvalidInput, "endpoint");
+	}
+};
+
+}  // namespace clime
+
+
+TEST_F(TestCommandlineParser, customValueParser) {
+	Endpoint endpoint{"", 0};
+	float32 ratio = 0;
+	auto parser = Parser{"Custom types", {
+		{{"listen"}, "Endpoint to listen on", &endpoint}
+	}};
+	parser.arguments({{"ratio", "Ratio", &ratio}});
+
+	char const* argv[] = {"prog", "--listen", "localhost:8080", "0.5"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ("localhost", endpoint.host);
+	EXPECT_EQ(8080, endpoint.port);
+	EXPECT_FLOAT_EQ(0.5f, ratio);
+
+	char const* badArgv[] = {"prog", "--listen=localhost", "0.5"};
+	auto result = parser.parse(arrayView(badArgv));
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(ParserError::OptionParsing, parserErrorCode(result.getError()));
+}
+
+
+TEST_F(TestCommandlineParser, optionConstraints) {
+	uint16 port = 0;
+	bool tcp = false;
+	bool udp = false;
+	StringView tlsKey;
+	StringView tlsCert;
+	bool quiet = false;
+	bool verbose = false;
+
+	auto parser = Parser{"Constraints", {
+		{{"port"}, "Port", &port},
+		{{"tcp"}, "TCP", &tcp},
+		{{"udp"}, "UDP", &udp},
+		{{"tls-key"}, "TLS key", &tlsKey},
+		{{"tls-cert"}, "TLS certificate", &tlsCert},
+		{{"q", "quiet"}, "Quiet", &quiet},
+		{{"v", "verbose"}, "Verbose", &verbose}
+	}};
+	parser.constraints({
+		Parser::Constraint::required("port"),
+		Parser::Constraint::exactlyOne({"tcp", "udp"}),
+		Parser::Constraint::dependsOn("tls-key", {"tls-cert"}),
+		Parser::Constraint::conflictsWith("quiet", {"verbose"})
+	});
+
+	auto expectError = [&parser](std::initializer_list<char const*> args, ParserError code, StringView tag) {
+		std::vector<char const*> argv{args};
+		auto result = parser.parse(arrayView(argv.data(), argv.size()));
+		ASSERT_TRUE(result.isError());
+		EXPECT_EQ(static_cast<int>(code), result.getError().value());
+		EXPECT_EQ(tag, result.getError().tag());
+	};
+
+	char const* argv[] = {"prog", "--port=80", "--tcp", "--tls-key=k", "--tls-cert=c", "-q"};
+	EXPECT_TRUE(parser.parse(arrayView(argv)).isOk());
+
+	expectError({"prog", "--tcp"}, ParserError::MissingOption, "port");
+	expectError({"prog", "--port=80"}, ParserError::MissingOption, "tcp");
+	expectError({"prog", "--port=80", "--tcp", "--udp"}, ParserError::ConflictingOptions, "udp");
+	expectError({"prog", "--port=80", "--udp", "--tls-key=k"}, ParserError::MissingOption, "tls-cert");
+	expectError({"prog", "--port=80", "--udp", "-q", "-v"}, ParserError::ConflictingOptions, "verbose");
+}
+
+
+TEST_F(TestCommandlineParser, constraintErrorOutlivesParser) {
+	bool quiet = false;
+	bool verbose = false;
+
+	auto result = [&]() {
+		auto parser = Parser{"Constraints", {
+			{{"q", "quiet"}, "Quiet", &quiet},
+			{{"v", "verbose"}, "Verbose", &verbose}
+		}};
+		parser.constraints({Parser::Constraint::conflictsWith("quiet", {"verbose"})});
+
+		char const* argv[] = {"prog", "-q", "-v"};
+		return parser.parse(arrayView(argv));
+	}();
+
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(StringView("verbose"), result.getError().tag());
+}
+
+
+TEST_F(TestCommandlineParser, constraintOnUnknownOption) {
+	bool flag = false;
+	auto parser = Parser{"Constraints", {
+		{{"flag"}, "Flag", &flag}
+	}};
+
+	// Unknown option is a programming error caught when the constraint is added
+	EXPECT_DEBUG_DEATH(parser.constraints({Parser::Constraint::atMostOne({"flag", "missing"})}), "unknown option");
+
+#ifdef NDEBUG
+	char const* argv[] = {"prog", "--flag"};
+	auto result = parser.parse(arrayView(argv));
+	ASSERT_TRUE(result.isError());
+	EXPECT_EQ(static_cast<int>(ParserError::InvalidInput), result.getError().value());
+	EXPECT_EQ(StringView("missing"), result.getError().tag());
+#endif
+}
+
+
+TEST_F(TestCommandlineParser, moveConstruction) {
+	bool verbose = false;
+	int32 size = 0;
+	StringView target;
+
+	auto parser = Parser{"Move construction"};
+	parser.options(Parser::Option{{"v", "verbose"}, "Verbose", &verbose},
+				   Parser::Option{{"size"}, "Size", &size});
+	parser.addCommand("status", "Query status", []() -> Result<void, Error> { return Ok(); })
+			.arguments(Parser::Argument{"target", "Target", &target});
+
+	// Parser is movable, sub-commands are kept in place
+	auto moved = mv(parser);
+	ASSERT_EQ(2U, moved.options().size());
+	ASSERT_EQ(1U, moved.commands().size());
+
+	char const* argv[] = {"prog", "-v", "--size=3", "status", "db"};
+	ASSERT_TRUE(moved.parse(arrayView(argv)).isOk());
+	EXPECT_TRUE(verbose);
+	EXPECT_EQ(3, size);
+	EXPECT_EQ(StringView("db"), target);
+}
+
+
+TEST_F(TestCommandlineParser, lazyCommandBuiltOnFirstUse) {
+	int nbBuilt = 0;
+	int32 level = 0;
+	auto const version = Version{1, 2, 3};
+
+	auto parser = Parser{"Lazy commands", {
+		Parser::printVersion("prog", version)
+	}};
+	parser.addCommand("heavy", Parser::Command::lazy("Expensive command", [&nbBuilt, &level]() {
+		nbBuilt += 1;
+		return Parser::Command{{}, []() -> Result<void, Error> { return Ok(); }, {
+			{{"level"}, "Level", &level}
+		}};
+	}));
+
+	// Listing commands and pre-scanned top-level options don't build the command
+	std::stringstream output;
+	HelpFormatter{}(output, "prog", parser.defaultAction());
+	EXPECT_NE(std::string::npos, output.str().find("Expensive command"));
+
+	char const* versionArgv[] = {"prog", "--version", "heavy"};
+	auto versionResult = parser.parse(arrayView(versionArgv));
+	ASSERT_TRUE(versionResult.isError());
+	EXPECT_EQ(static_cast<int>(ParserError::NoError), versionResult.getError().value());
+	EXPECT_EQ(0, nbBuilt);
+
+	char const* argv[] = {"prog", "heavy", "--level=3"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(1, nbBuilt);
+	EXPECT_EQ(3, level);
+	EXPECT_EQ(StringView("Expensive command"), parser.commands().at("heavy").resolve().unwrap()->description());
+}
+
+
+TEST_F(TestCommandlineParser, multiCallSelectsCommandByProgramName) {
+	bool longFormat = false;
+	auto const version = Version{1, 2, 3};
+	auto parser = Parser{"Multi-call", {
+		Parser::printVersion("tool", version)
+	}};
+	parser.multiCall()
+		.addCommand("ls", "List files", []() -> Result<void, Error> { return Ok(); })
+		.options(Parser::Option{{"l"}, "Long format", &longFormat});
+
+	char const* appletArgv[] = {"/usr/bin/ls", "-l"};
+	EXPECT_EQ(StringView("ls"), parser.appletName(arrayView(appletArgv)));
+	auto maybeCommand = parser.resolve(arrayView(appletArgv));
+	ASSERT_TRUE(maybeCommand.isOk());
+	EXPECT_EQ(StringView("List files"), maybeCommand.unwrap()->description());
+	EXPECT_TRUE(longFormat);
+
+	// Unknown program names fall back to the usual parsing
+	longFormat = false;
+	char const* toolArgv[] = {"./tool", "ls", "-l"};
+	EXPECT_TRUE(parser.appletName(arrayView(toolArgv)).empty());
+	ASSERT_TRUE(parser.resolve(arrayView(toolArgv)).isOk());
+	EXPECT_TRUE(longFormat);
+
+	// Version is scoped to the applet
+	char const* versionArgv[] = {"ls", "--version"};
+	testing::internal::CaptureStdout();
+	auto versionResult = parser.parse(arrayView(versionArgv));
+	auto const output = testing::internal::GetCapturedStdout();
+	ASSERT_TRUE(versionResult.isError());
+	EXPECT_EQ(static_cast<int>(ParserError::NoError), versionResult.getError().value());
+	EXPECT_EQ(0U, output.find("ls "));
+
+	parser.multiCall(false);
+	EXPECT_TRUE(parser.resolve(arrayView(appletArgv)).isError());
+}
+
+
+TEST_F(TestCommandlineParser, errorsCarryArgvPosition) {
+	uint16 port = 0;
+	auto parser = Parser{"Errors", {
+		{{"p", "port"}, "Port", &port}
+	}};
+
+	char const* argv[] = {"prog", "-p", "eighty"};
+	auto result = parser.parse(arrayView(argv));
+	ASSERT_TRUE(result.isError());
+
+	auto const info = parserErrorInfo(result.getError());
+	EXPECT_EQ(ParserError::OptionParsing, info.code);
+	EXPECT_EQ(ValueKind::Unsigned, info.expected);
+	EXPECT_EQ(2U, info.argvIndex);
+	EXPECT_EQ(static_cast<void const*>(argv[2]), static_cast<void const*>(info.token.data()));
+
+	char buffer[128];
+	auto const length = formatParserError(result.getError(), buffer, sizeof(buffer));
+	EXPECT_EQ(StringView("argv[2] 'eighty': error parsing option value (unsigned integer)"), StringView(buffer));
+	EXPECT_EQ(std::strlen(buffer), length);
+
+	// Message is truncated to fit the buffer
+	char small[8];
+	EXPECT_EQ(length, formatParserError(result.getError(), small, sizeof(small)));
+	EXPECT_EQ(StringView("argv[2]"), StringView(small));
+
+	char const* unknownArgv[] = {"prog", "--port=80", "--bogus=1"};
+	auto unknown = parser.parse(arrayView(unknownArgv));
+	ASSERT_TRUE(unknown.isError());
+	EXPECT_EQ(ParserError::UnexpectedValue, parserErrorCode(unknown.getError()));
+	EXPECT_EQ(2U, parserErrorInfo(unknown.getError()).argvIndex);
+	EXPECT_EQ(StringView("bogus"), unknown.getError().tag());
+
+	// Errors made without a position have none
+	auto const plain = makeParserError(ParserError::MissingOption, "port");
+	EXPECT_EQ(ParserErrorInfo::kNoPosition, parserErrorInfo(plain).argvIndex);
+	formatParserError(plain, buffer, sizeof(buffer));
+	EXPECT_EQ(StringView("port: required option missing"), StringView(buffer));
+}
+
+
+TEST_F(TestCommandlineParser, validateCollectsAllErrors) {
+	uint16 port = 0;
+	bool verbose = false;
+	bool copied = false;
+	StringView src;
+	StringView dst;
+	auto parser = Parser{"Validation", {
+		Parser::printHelp(),
+		{{"p", "port"}, "Port", &port},
+		{{"v", "verbose"}, "Verbose output", &verbose}
+	}};
+	parser.commands({
+		{"copy", {"Copy a file", {{"src", "Source", &src}, {"dst", "Destination", &dst}},
+				  [&copied]() -> Result<void, Error> { copied = true; return Ok(); }}}
+	});
+
+	char const* argv[] = {"prog", "-v", "--help", "--bogus", "--port=eighty", "copy", "only-one"};
+	Diagnostics diagnostics;
+	auto result = parser.validate(arrayView(argv), diagnostics);
+	ASSERT_TRUE(result.isError());
+	ASSERT_EQ(3U, diagnostics.size());
+	EXPECT_FALSE(diagnostics.isTruncated());
+	EXPECT_EQ(3U, parserErrorInfo(result.getError()).argvIndex);
+
+	EXPECT_EQ(ParserError::UnexpectedValue, parserErrorCode(diagnostics.errors()[0]));
+	EXPECT_EQ(ParserError::OptionParsing, parserErrorCode(diagnostics.errors()[1]));
+	EXPECT_EQ(4U, parserErrorInfo(diagnostics.errors()[1]).argvIndex);
+	EXPECT_EQ(ParserError::InvalidNumberOfArgs, parserErrorCode(diagnostics.errors()[2]));
+	EXPECT_EQ(7U, parserErrorInfo(diagnostics.errors()[2]).argvIndex);
+
+	// Parsing has carried on past errors, but neither help nor the action have been run
+	EXPECT_TRUE(verbose);
+	EXPECT_FALSE(copied);
+
+	// Errors past the capacity of the list are counted but not kept
+	Diagnostics bounded{1};
+	EXPECT_TRUE(parser.validate(arrayView(argv), bounded).isError());
+	EXPECT_EQ(1U, bounded.size());
+	EXPECT_EQ(3U, bounded.total());
+	EXPECT_TRUE(bounded.isTruncated());
+
+	char const* validArgv[] = {"prog", "-p", "80", "copy", "a", "b"};
+	diagnostics.clear();
+	auto valid = parser.validate(arrayView(validArgv), diagnostics);
+	ASSERT_TRUE(valid.isOk());
+	EXPECT_EQ(parser.defaultAction().commands().find("copy")->second.resolve().unwrap(), valid.unwrap());
+	EXPECT_TRUE(diagnostics.empty());
+}
+
+
+TEST_F(TestCommandlineParser, subCommandOptionsShadowPreScannedOptions) {
+	bool verbose = false;
+	StringView host;
+	auto const version = Version{1, 2, 3};
+	auto parser = Parser{"Pre-scan", {
+		Parser::printHelp(),
+		Parser::printVersion("prog", version)
+	}};
+	parser.addCommand("sub", "Sub-command", []() -> Result<void, Error> { return Ok(); })
+		.options(Parser::Option{{"v", "verbose"}, "Verbose output", &verbose},
+				 Parser::Option{{"h", "host"}, "Host", &host});
+
+	char const* verboseArgv[] = {"prog", "sub", "-v"};
+	ASSERT_TRUE(parser.parse(arrayView(verboseArgv)).isOk());
+	EXPECT_TRUE(verbose);
+
+	char const* hostArgv[] = {"prog", "sub", "-h", "example.com"};
+	ASSERT_TRUE(parser.parse(arrayView(hostArgv)).isOk());
+	EXPECT_EQ(StringView("example.com"), host);
+
+	// Top-level options are still handled before the sub-command
+	char const* versionArgv[] = {"prog", "-v", "sub"};
+	testing::internal::CaptureStdout();
+	auto versionResult = parser.parse(arrayView(versionArgv));
+	testing::internal::GetCapturedStdout();
+	ASSERT_TRUE(versionResult.isError());
+	EXPECT_EQ(static_cast<int>(ParserError::NoError), versionResult.getError().value());
+}
+
+
+TEST_F(TestCommandlineParser, preScannedOptionIsCalledOnce) {
+	int nbCalls = 0;
+	StringView level;
+	auto parser = Parser{"Pre-scan", {
+		Parser::Option{{"l", "log-level"}, "Log level", Parser::ArgumentValue::Required,
+			[&nbCalls, &level](Optional<StringView> const& value, Parser::Context const&) -> Optional<Error> {
+				nbCalls += 1;
+				level = value.get();
+				return none;
+			}}.preScanned()
+	}};
+	parser.addCommand("sub", "Sub-command", []() -> Result<void, Error> { return Ok(); });
+
+	char const* argv[] = {"prog", "-l", "debug", "sub"};
+	ASSERT_TRUE(parser.parse(arrayView(argv)).isOk());
+	EXPECT_EQ(1, nbCalls);
+	EXPECT_EQ(StringView("debug"), level);
+}
@@ -0,0 +1,144 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_stringArena.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/stringArena.hpp>  // Class being tested
+#include <clime/parseCache.hpp>
+#include <clime/parser.hpp>
+
+#include <solace/output_utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+TEST(TestStringArena, emptyArenaHasNoCapacity) {
+	StringArena arena;
+	EXPECT_EQ(0U, arena.used());
+	EXPECT_EQ(0U, arena.capacity());
+}
+
+TEST(TestStringArena, copyIsNullTerminated) {
+	StringArena arena{16};
+	char buffer[] = "value-with-tail";
+	auto const value = StringView{buffer, 5};
+
+	auto const copy = arena.copy(value);
+	EXPECT_EQ(StringView{"value"}, copy);
+	EXPECT_EQ(0, copy.data()[copy.size()]);
+	EXPECT_NE(buffer, copy.data());
+	EXPECT_TRUE(arena.owns(copy));
+	EXPECT_FALSE(arena.owns(value));
+}
+
+TEST(TestStringArena, oversizedValueGetsDedicatedBlock) {
+	StringArena arena{8};
+	auto const small = arena.copy("abc");
+	auto const large = arena.copy("a value longer then the block");
+	auto const next = arena.copy("xyz");
+
+	EXPECT_EQ(StringView{"abc"}, small);
+	EXPECT_EQ(StringView{"a value longer then the block"}, large);
+	EXPECT_EQ(StringView{"xyz"}, next);
+
+	// Small values share the block
+	EXPECT_EQ(small.data() + 4, next.data());
+}
+
+TEST(TestStringArena, resetKeepsFirstBlock) {
+	StringArena arena{8};
+	arena.copy("1234");
+	arena.copy("5678");
+	arena.copy("9abc");
+
+	EXPECT_EQ(24U, arena.capacity());
+	arena.reset();
+	EXPECT_EQ(0U, arena.used());
+	EXPECT_EQ(8U, arena.capacity());
+}
+
+TEST(TestStringArena, parserCopiesValuesFromTransientBuffer) {
+	StringView option;
+	StringView argument;
+
+	StringArena arena;
+	auto parser = Parser{"test_app", {
+			{{"n", "name"}, "Name", &option}
+		}};
+	parser.arguments({
+			{"file", "File to process", &argument}
+		});
+
+	{
+		std::string buffer[] = {"prog", "--name", "transient", "input.txt"};
+		const char* argv[] = {buffer[0].c_str(), buffer[1].c_str(), buffer[2].c_str(), buffer[3].c_str()};
+
+		auto result = parser.parse(arrayView(argv), arena);
+		ASSERT_TRUE(result.isOk());
+
+		for (auto& token : buffer) {
+			token.assign(token.size(), '#');
+		}
+	}
+
+	EXPECT_EQ(StringView{"transient"}, option);
+	EXPECT_EQ(StringView{"input.txt"}, argument);
+	EXPECT_TRUE(arena.owns(option));
+	EXPECT_TRUE(arena.owns(argument));
+}
+
+TEST(TestStringArena, parserWithoutArenaPointsIntoArgv) {
+	StringView option;
+	const char* argv[] = {"prog", "--name", "persistent"};
+
+	auto result = Parser{"test_app", {
+			{{"n", "name"}, "Name", &option}
+		}}
+		.parse(arrayView(argv));
+	ASSERT_TRUE(result.isOk());
+
+	EXPECT_EQ(argv[2], option.data());
+}
+
+TEST(TestStringArena, parseEndsWhenCallbackThrows) {
+	StringArena arena;
+	auto parser = Parser{"test_app", {
+			{{"t", "throw"}, "Throw from the callback", Parser::ArgumentValue::NotRequired,
+				[](Optional<StringView> const&, Parser::Context const&) -> Optional<Error> {
+					throw std::runtime_error("callback failed");
+				}}
+		}};
+
+	const char* throwingArgv[] = {"prog", "--throw"};
+	EXPECT_THROW(parser.parse(arrayView(throwingArgv), arena), std::runtime_error);
+
+	ParseTrace trace;
+	EXPECT_THROW(parser.parse(arrayView(throwingArgv), trace, &arena), std::runtime_error);
+
+	// The arena is no longer in use by a parse: it can be reset and used again
+	arena.reset();
+	const char* argv[] = {"prog"};
+	EXPECT_TRUE(parser.parse(arrayView(argv), arena).isOk());
+}
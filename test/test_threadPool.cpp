@@ -0,0 +1,82 @@
+/*
+*  Copyright 2020 Ivan Ryabov
+*
+*  Licensed under the Apache License, Version 2.0 (the "License");
+*  you may not use this file except in compliance with the License.
+*  You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+*  Unless required by applicable law or agreed to in writing, software
+*  distributed under the License is distributed on an "AS IS" BASIS,
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+*  See the License for the specific language governing permissions and
+*  limitations under the License.
+*/
+/*******************************************************************************
+ * libclime Unit Test Suit
+ * @file: test/test_threadPool.cpp
+ * @author: abbyssoul
+*******************************************************************************/
+#include <clime/threadPool.hpp>  // Class being tested
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+
+using namespace Solace;
+using namespace clime;
+
+
+TEST(TestThreadPool, forEachConcurrentlyVisitsEveryIndexOnce) {
+	ThreadPool pool{3};
+	std::vector<std::atomic<int>> visits(1000);
+
+	forEachConcurrently(pool, static_cast<uint32>(visits.size()), 4, [&visits](uint32 index) {
+		visits[index] += 1;
+		return true;
+	});
+
+	for (auto const& count : visits) {
+		EXPECT_EQ(1, count.load());
+	}
+}
+
+TEST(TestThreadPool, forEachConcurrentlyDoesNotWaitForBusyPool) {
+	ThreadPool pool{1};
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	pool.post([released]() { released.wait(); });  // The only worker is busy
+
+	uint32 sum = 0;
+	forEachConcurrently(pool, 100, 2, [&sum](uint32 index) {
+		sum += index;
+		return true;
+	});
+
+	// Calling thread has done all the work, the helper starts late and does nothing
+	EXPECT_EQ(4950U, sum);
+	release.set_value();
+}
+
+TEST(TestThreadPool, forEachConcurrentlyStopsWhenBodyFails) {
+	std::atomic<uint32> calls{0};
+	InlineExecutor executor;
+
+	forEachConcurrently(executor, 100, 1, [&calls](uint32 index) {
+		calls += 1;
+		return index < 9;
+	});
+
+	EXPECT_EQ(10U, calls.load());
+}
+
+TEST(TestThreadPool, sharedPoolIsKeptAcrossCalls) {
+	auto& pool = ThreadPool::shared();
+	EXPECT_EQ(&pool, &ThreadPool::shared());
+	EXPECT_LE(1U, pool.size());
+}